@@ -14,6 +14,11 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <sys/resource.h>
 #include "ns3/aodv-module.h"
 #include "ns3/dsr-module.h"
 #include "ns3/dsdv-module.h"
@@ -25,6 +30,7 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/v4ping-helper.h"
 #include "ns3/yans-wifi-helper.h"
+#include "ns3/spectrum-wifi-helper.h"
 #include "ns3/netanim-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/ssid.h"
@@ -36,73 +42,125 @@
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/ipv4-flow-classifier.h"
 #include "ns3/rng-seed-manager.h"
+#include "run-result.h"
+#include "sweep-runner.h"
+#include "grid-spectrum-channel.h"
+#include "link-budget-cache.h"
+#include "vehicle-trace.h"
+#include "routing-selector.h"
+#include "vehicle-state-table.h"
+#include "flow-table.h"
+#include "flow-stats-collector.h"
+#include "traffic-counters.h"
+#include "throughput-sampler.h"
+#include "pcap-capture.h"
+#include "routing-recorder.h"
+#include "anim-writer.h"
+#include "hop-sampler.h"
+#include "event-log.h"
+#include "results-store.h"
+#include "replication-controller.h"
+#include "profiling-scheduler.h"
+#include "cbr-generator.h"
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("VanetRC");
 
-
-/*
-class modified_Node : public Node
-{
-  private:
-    //data
-    uint32_t condition;
-      
-  public:
-    modified_Node();
-
-    modified_Node(uint32_t);
-    ~modified_Node();
-
-    uint32_t getCondition();
-};
-
-class modified_NodeContainer : public NodeContainer
+// Wall-clock seconds since start
+static double
+secondsSince (std::chrono::steady_clock::time_point start)
 {
-  private:
-    // data
-    std::vector<Ptr<modified_Node> > m_nodes; //!< Nodes smart pointers
-  public:
-    modified_NodeContainer();
-    ~modified_NodeContainer();
-    void Create (uint32_t n);
-};
-
-modified_Node::modified_Node ()
-: condition (0) {}
-
-modified_Node::modified_Node (uint32_t c)
-: condition (c) {}
-
-uint32_t
-modified_Node::getCondition()
-{
-    return condition;
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
 }
 
-void
-modified_NodeContainer::Create (uint32_t n)
-{
-  for (uint32_t i = 0; i < n; i++)
-    {
-      m_nodes.push_back (CreateObject<modified_Node> ());
-    }
-}
-*/
-
 class RoutingExample
 {
   public:
-    void run();
+    RunResult run();
+    // Builds the network and simulates the shared prefix up to warmup
+    void warmUp();
+    // Installs the traffic of this replication and runs to totalTime
+    RunResult finishRun();
     // argc & argv configuration
     void configuration(int argc, char ** argv);
+    // Appends one replication to the results store
+    // False if a store refused the row
+    bool writeReport(const RunResult &r);
+    // Runs every (connections, seed) pair of the sweep on a worker pool
+    int runSweep();
     // Number of nodes
     uint32_t size = 25;
+    // Columns of the static grid, 0 for as close to square as size allows
+    uint32_t gridWidth = 5;
     // Seed Value
     uint32_t seed = 1;
     // Number of Connections
     uint32_t connections = 5;
+    // Data rate of each flow
+    std::string dataRate = "150kb/s";
+    // Flow sender: "onoff" (one OnOffApplication per flow) or "cbr" (one
+    // timer wheel for every flow, with slots of cbrSlot seconds)
+    std::string trafficMode = "onoff";
+    double cbrSlot = 0.001;
+    // Sweep lists ("1:100", "5,10,15,20"), empty for a single run
+    std::string sweepSeeds;
+    std::string sweepConnections;
+    // Number of worker processes of the sweep, 0 means one per core
+    uint32_t jobs = 0;
+    // Stop a connection count's seeds once the confidence interval half
+    // width of PDF, delay and rx bitrate is within this fraction of the
+    // mean, 0 to run every seed
+    double targetCi = 0;
+    double ciLevel = 0.95;
+    uint32_t minSeeds = 5;
+    // Warm-start point of a sweep, seconds (0 builds every replication from scratch)
+    double warmup = 0;
+    // Wifi channel: "yans" delivers every frame to every phy, "grid" only
+    // to the phys within decodable range
+    std::string channel = "yans";
+    // Precompute pairwise gain and delay once, nodes must not move
+    bool staticTopology = false;
+    // Routing protocol name
+    std::string routingName = "aodv";
+    // Results store every replication is appended to (results-store.h)
+    std::string resultsFile = "xml/VanetRC-results.csv";
+    // Second results store, empty for none
+    std::string benchReport;
+    // Binary vehicle trace (tools/vanetrc-trace-convert), empty for the static grid
+    std::string traceFile;
+    // "source sink start stop" flow list, empty to draw connections random flows
+    std::string flowFile;
+    // Merged capture filter: "all", "data" or "control", empty for none
+    std::string capture;
+    // Nodes to capture ("0:9", "3,7"), empty for all
+    std::string captureNodes;
+    // Bytes kept of each captured packet
+    uint32_t snapLen = 128;
+    // Whole-run NetAnim trace: position changes every animPoll seconds,
+    // one packet in animSample
+    bool animLight = false;
+    double animPoll = 1;
+    double animMinMove = 1;
+    uint32_t animSample = 20;
+    // Routing snapshot interval, seconds, 0 for the three text dumps
+    double routeInterval = 0;
+    // Throughput sampling interval, seconds, 0 for none
+    double sampleInterval = 0;
+    // Also run FlowMonitor and write its XML
+    bool flowmon = false;
+    // Nodes FlowMonitor probes: "endpoints" (flow sources and sinks) or "all"
+    std::string flowmonProbes = "endpoints";
+    // Follow one data packet in this many hop by hop, 0 for none
+    uint32_t hopSample = 0;
+    // Print the scenario, flow set up and per-flow results as text
+    bool verbose = false;
+    // Per-flow statistics file: "none", "bin" or "xml"
+    std::string flowStatsFormat = "none";
+    // End the run once the data flows are over instead of at totalTime
+    bool autoStop = false;
+    // Simulated time kept after quiescence, seconds
+    double drain = 1;
 
   private:
     // parameters
@@ -115,24 +173,45 @@ class RoutingExample
     // Write per-device PCAP traces if true & net-anim file generate
     bool pcap = true;
     bool anim = false;
-    // Print routes if true
+    // Dump the routing tables as text at 15, 16 and 30 s with --verbose
     bool printRoutes = true;
     //Size of Packet (bytes), Packet interval (Time), Max Packets
     double packet_size = 1024;
     Time packet_interval = MilliSeconds (1000);
     double max_packets = 250;
-    StringValue data_rate = StringValue("150kb/s");
+    StringValue data_rate;
     //Internet Stack Helper
     InternetStackHelper stack;
-    //Pointer to the packet sink application 
-    Ptr<PacketSink> sink[20];
-    //The value of the last total received bytes
-    uint64_t lastTotalRx = 0;
-    //Routing Method
-    AodvHelper routing;
-    //OlsrHelper routing;
-    //DsdvHelper routing;
-    // you can configure AODV attributes here using aodv.Set(name, value)
+    // The packet sinks, one per destination node
+    std::vector<Ptr<PacketSink> > sinks;
+    // Data flows of the replication
+    FlowTable flows;
+    // Per-flow counters of the data flows
+    Ptr<FlowStatsCollector> flowStats;
+    // Sender of every flow with --traffic=cbr
+    Ptr<CbrGenerator> cbr;
+    // Decimated, compressed NetAnim trace (--anim-light)
+    Ptr<AnimWriter> animWriter;
+    // Full NetAnim trace (--anim), alive until the run is over
+    std::unique_ptr<AnimationInterface> animInterface;
+    // Binary routing snapshots and diffs (--route-interval)
+    Ptr<RoutingRecorder> routeRecorder;
+    // Merged capture written by a background thread (--capture)
+    Ptr<PcapCapture> pcapCapture;
+    // Rx bytes per flow and per node over time (--sample-interval)
+    Ptr<ThroughputSampler> sampler;
+    // Hops and relays of sampled data packets (--hop-sample)
+    Ptr<HopSampler> hopSampler;
+    // Scenario events of the replication, written to xml/events-*.bin
+    Ptr<EventLog> eventLog;
+    //Routing Method, aodv, olsr, dsdv or dsr (--routing)
+    RoutingSelector routing;
+    // you can configure AODV attributes in installInternetStack using routing.GetAodv().Set(name, value)
+    // Wall-clock start of the replication
+    std::chrono::steady_clock::time_point wallStart;
+    // Wall-clock time of createDevices and installInternetStack, s
+    double devicesSeconds = 0;
+    double stackSeconds = 0;
 
     // network
     // nodes used in the example
@@ -141,8 +220,25 @@ class RoutingExample
     NetDeviceContainer devices;
     // interfaces used in the example
     Ipv4InterfaceContainer interfaces;
+    // Per-vehicle condition, role, flows and position snapshot
+    Ptr<VehicleStateTable> vehicleStates;
+    // Trace replayed by the nodes' mobility models, if any
+    Ptr<VehicleTrace> vehicleTrace;
+    // Data and control traffic, counted from the network build on so that
+    // a warm start also counts the warm-up
+    Ptr<TrafficCounters> traffic;
+    // Flow monitor (--flowmon), installed with the network with
+    // --flowmon-probes=all, on the flow endpoints with the traffic otherwise
+    FlowMonitorHelper flowHelper;
+    Ptr<FlowMonitor> flowMonitor;
+    // Appended to output file names so concurrent replications do not collide
+    std::string outputSuffix;
   
   private:
+    // Nodes, devices, internet stack and flow monitor
+    void buildNetwork ();
+    // Applications and the traces that depend on them
+    void installTraffic ();
     // Create the nodes (i -> quantity)
     void createNodes (int i);
     // Create the devices
@@ -152,198 +248,544 @@ class RoutingExample
     // Create the simulation applications
     void installApplications ();
     void installOnOffApplications ();
+    // Draw connections random flows into the flow table
+    void generateFlows ();
+    // Stops the simulation after drain once no data packet is in flight
+    void checkQuiescence ();
     // Saves all nodes' routing tables in a txt file
     void printingRoutingTable ();
+    // Log a text dump of the routing tables when it actually happens
+    void logRouteDump (uint32_t dump);
     // Saves all nodes' pcap tracing file
     void enablePcapTracing ();
-    // Calculate the throughput of network
-    void calculateThroughput();
+    // Starts the merged, filtered capture (--capture)
+    void enableCapture ();
     
 };
 
-void
+RunResult
 RoutingExample::run(){
+  wallStart = std::chrono::steady_clock::now ();
+  buildNetwork();
+  return finishRun();
+};
+
+void
+RoutingExample::warmUp(){
+  buildNetwork();
+  // Routing converges on HELLO traffic alone, which is the same for every
+  // replication of the sweep; the forked replications continue from here
+  Simulator::Stop (Seconds (warmup));
+  Simulator::Run ();
+#ifdef VANETRC_PROFILE
+  ProfilingScheduler::GetCurrent ()->Finish ();
+#endif
+};
+
+void
+RoutingExample::buildNetwork(){
+#ifdef VANETRC_PROFILE
+  // Profile builds count and time every event by source
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::ProfilingScheduler");
+  Simulator::SetScheduler (scheduler);
+#endif
  
-  // Enable logging for UdpClient and
-  LogComponentEnable ("UdpEchoClientApplication", LOG_LEVEL_INFO);
-  LogComponentEnable ("UdpEchoServerApplication", LOG_LEVEL_INFO);
+  if (verbose){
+    LogComponentEnable ("UdpEchoClientApplication", LOG_LEVEL_INFO);
+    LogComponentEnable ("UdpEchoServerApplication", LOG_LEVEL_INFO);
+  }
 
   createNodes(size);
 
   
-  Ptr<Node> a = nodes.Get(uint32_t(18));
-  Ptr<Node> b = nodes.Get(uint32_t(2));
-  a->SetCondition(uint32_t(5));
-  b->SetCondition(uint32_t(5));
-  /*
-  Node n = Node();
-  n.SetCondition(uint32_t(5));
-  uint32_t x = n.GetCondition();
- 
-  std::cout << std::endl << "condition: \t" << x << std::endl;
-  */
+  // Condition, role, flows and positions of every vehicle, by node id
+  vehicleStates = Create<VehicleStateTable> (nodes.GetN ());
+  NS_ABORT_MSG_IF (size < 19, "Nodes 2 and 18 have condition 5, size must be at least 19");
+  vehicleStates->SetCondition(18, 5);
+  vehicleStates->SetCondition(2, 5);
+  routing.SetStateTable(vehicleStates);
 
 
+  std::chrono::steady_clock::time_point phase = std::chrono::steady_clock::now ();
   createDevices();
+  devicesSeconds = secondsSince (phase);
+  phase = std::chrono::steady_clock::now ();
   installInternetStack();
-  installOnOffApplications();
-  if(pcap) enablePcapTracing();
-  if(printRoutes) printingRoutingTable();
-  if(anim){
-    AnimationInterface anim (std::string("xml/test.xml"));
-    anim.EnablePacketMetadata (); // Optional
-    anim.EnableIpv4RouteTracking ("xml/vanetRC-routingtable.xml", Seconds (0), Seconds (60)); //Optional
-    //anim.EnableWifiMacCounters (Seconds (0), Seconds (totalTime)); //Optional
-    //anim.EnableWifiPhyCounters (Seconds (0), Seconds (totalTime)); //Optional
-    //anim.SetMaxPktsPerTraceFile(500000);
-    anim.SetStartTime (Seconds(0.0));
-    anim.SetStopTime (Seconds(10.0));
-  }
-
-  Ptr<FlowMonitor> flowMonitor;
-  FlowMonitorHelper flowHelper;
-  flowMonitor = flowHelper.InstallAll();
-  std::string file_path = "xml/flowmonitor/flowmon-";
-  file_path += std::to_string(connections);
-  file_path += ".xml";
+  stackSeconds = secondsSince (phase);
 
+  traffic = Create<TrafficCounters> (autoStop);
+  traffic->Install(nodes);
+  if (flowmon && flowmonProbes == "all"){
+    flowMonitor = flowHelper.InstallAll();
+  }
   /*
   FlowMonitorHelper flowmonHelper;
   flowmonHelper.InstallAll ();
   */
+};
 
-  Simulator::Stop (Seconds (totalTime));
-  Simulator::Run ();
+void
+RoutingExample::checkQuiescence(){
+  // A data packet is in flight until it is received, dropped or, after
+  // 10 s (FlowMonitor's MaxPerHopDelay) without progress, lost. Once none
+  // is, the final counters are those of a run to totalTime
+  if (traffic->ExpireDataInFlight (Seconds (10)) == 0){
+    eventLog->Add (EVENT_QUIESCENT);
+    if (verbose){
+      std::cout << "\n Quiescent at: \t\t" << Simulator::Now ().GetSeconds () << "s\n";
+    }
+    Simulator::Stop (Seconds (drain));
+    return;
+  }
+  Simulator::Schedule (MilliSeconds (100), &RoutingExample::checkQuiescence, this);
+};
 
-  std::cout << "\n------------------------------Measurement With 'SinkHelper'-------------------------------------\n\n";
+void
+RoutingExample::installTraffic(){
+  installOnOffApplications();
+  if(flowmon && flowmonProbes == "endpoints"){
+    // Endpoint probes see every data packet sent and received, so tx, rx,
+    // delay and loss stay exact; relays pay no classification
+    std::vector<bool> endpoint (nodes.GetN (), false);
+    NodeContainer probed;
+    for (uint32_t i = 0; i < flows.GetN(); i++){
+      const FlowSpec &flow = flows.Get(i);
+      if (!endpoint[flow.source]){
+        endpoint[flow.source] = true;
+        probed.Add (nodes.Get (flow.source));
+      }
+      if (!endpoint[flow.sink]){
+        endpoint[flow.sink] = true;
+        probed.Add (nodes.Get (flow.sink));
+      }
+    }
+    flowMonitor = flowHelper.Install(probed);
+  }
+  if(hopSample > 0){
+    hopSampler = Create<HopSampler> (flows, hopSample);
+    hopSampler->Install (nodes);
+  }
+  if(!capture.empty()){
+    enableCapture();
+  }else if(pcap){
+    enablePcapTracing();
+  }
+  if(routeInterval > 0){
+    routeRecorder = Create<RoutingRecorder> (routing.GetProtocol ());
+    routeRecorder->SetEventLog (eventLog);
+    NS_ABORT_MSG_UNLESS (routeRecorder->Start ("xml/routes" + outputSuffix + ".bin", nodes, Seconds (routeInterval)),
+                         "Cannot create the routing snapshot file");
+  }else if(verbose && printRoutes){
+    printingRoutingTable();
+  }
+  if(animLight){
+    animWriter = Create<AnimWriter> (Seconds (animPoll), animMinMove, animSample);
+    NS_ABORT_MSG_UNLESS (animWriter->Start ("xml/vanetrc-anim" + outputSuffix + ".xml.gz", nodes),
+                         "Cannot create the animation file");
+  }else if(anim){
+    animInterface.reset (new AnimationInterface (std::string("xml/test.xml")));
+    animInterface->EnablePacketMetadata (); // Optional
+    animInterface->EnableIpv4RouteTracking ("xml/vanetRC-routingtable.xml", Seconds (0), Seconds (60)); //Optional
+    //animInterface->EnableWifiMacCounters (Seconds (0), Seconds (totalTime)); //Optional
+    //animInterface->EnableWifiPhyCounters (Seconds (0), Seconds (totalTime)); //Optional
+    //animInterface->SetMaxPktsPerTraceFile(500000);
+    animInterface->SetStartTime (Seconds(0.0));
+    animInterface->SetStopTime (Seconds(10.0));
+  }
+};
 
-  std::cout << " Packet Size: \t\t" << packet_size << " Bytes, " << packet_size / 1024 << " KiloBytes \n";
-  std::cout << " Data Rate: \t\t" << data_rate.Get() << "\n\n";
-  /*
-  for (uint32_t i = 0; i < connections; i++)
+RunResult
+RoutingExample::finishRun(){
+  eventLog = Create<EventLog> ();
+  if (Simulator::Now ().IsStrictlyPositive ()){
+    eventLog->Add (EVENT_WARM_START);
+  }
+  installTraffic();
+
+  std::string file_path = "xml/flowmonitor/flowmon-";
+  file_path += std::to_string(connections);
+  file_path += outputSuffix;
+
+  // Stop is relative to now, which is the warm-up point of a warm start
+  Simulator::Stop (Seconds (totalTime) - Simulator::Now ());
+  if (autoStop && flows.GetN () > 0){
+    // Nothing can be quiescent before the last data application stops
+    Simulator::Schedule (Seconds (flows.GetLastStop ()) - Simulator::Now (), &RoutingExample::checkQuiescence, this);
+  }
+  if (sampleInterval > 0){
+    sampler = Create<ThroughputSampler> (flowStats, nodes.GetN ());
+    NS_ABORT_MSG_UNLESS (sampler->Start ("xml/throughput-" + std::to_string(connections) + outputSuffix + ".bin", Seconds (sampleInterval)),
+                         "Cannot create the throughput sample file");
+  }
+  double setupSeconds = secondsSince (wallStart);
+  std::chrono::steady_clock::time_point phase = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double runSeconds = secondsSince (phase);
+#ifdef VANETRC_PROFILE
+  ProfilingScheduler::GetCurrent ()->Finish ();
+#endif
+  phase = std::chrono::steady_clock::now ();
+  if (sampler){
+    sampler->Stop ();
+  }
+  if (pcapCapture){
+    pcapCapture->Close ();
+  }
+  if (routeRecorder){
+    routeRecorder->Stop ();
+  }
+  if (animWriter){
+    animWriter->Stop ();
+  }
+  // Closes xml/test.xml
+  animInterface.reset ();
+  if (hopSampler){
+    hopSampler->Stop ();
+  }
+
+  for (uint32_t i = 0; i < sinks.size(); i++)
   {
-    std::cout << " Packets Received: \t" << sink[i]->GetTotalRx() / double(packet_size) << "\n";
-    std::cout << " Bytes Received: \t" << sink[i]->GetTotalRx() << "\n";
-    std::cout << " Throughput: \t\t" << sink[i]->GetTotalRx() / 1024 / 20 << " KiloBytes/sec \n\n";
+    eventLog->Add (EVENT_SINK, sinks[i]->GetNode()->GetId(), 0, 0, sinks[i]->GetTotalRx());
+  }
+  if (verbose){
+    std::cout << "\n------------------------------Measurement With 'SinkHelper'-------------------------------------\n\n";
+
+    std::cout << " Packet Size: \t\t" << packet_size << " Bytes, " << packet_size / 1024 << " KiloBytes \n";
+    std::cout << " Data Rate: \t\t" << data_rate.Get() << "\n\n";
+    for (uint32_t i = 0; i < sinks.size(); i++)
+    {
+      std::cout << " Sink Node: \t\t" << sinks[i]->GetNode()->GetId() << "\n";
+      std::cout << " Packets Received: \t" << sinks[i]->GetTotalRx() / double(packet_size) << "\n";
+      std::cout << " Bytes Received: \t" << sinks[i]->GetTotalRx() << "\n";
+      // Active time: first to last delivery of any flow into this sink
+      uint32_t sinkId = sinks[i]->GetNode()->GetId();
+      int64_t firstRx = -1, lastRx = -1;
+      for (uint32_t f = 0; f < flowStats->GetN (); f++)
+      {
+        const FlowCounters &c = flowStats->Get (f);
+        if (flowStats->GetFlow (f).sink != sinkId || c.firstRx < 0){
+          continue;
+        }
+        if (firstRx < 0 || c.firstRx < firstRx){
+          firstRx = c.firstRx;
+        }
+        lastRx = std::max (lastRx, c.lastRx);
+      }
+      double active = firstRx >= 0 ? TimeStep (lastRx - firstRx).GetSeconds () : 0;
+      std::cout << " Throughput: \t\t" << (active > 0 ? sinks[i]->GetTotalRx() / 1024.0 / active : 0) << " KiloBytes/sec \n\n";
+    }
+    std::cout << "\n--------------------------------------------------------------------------------------------\n";
   }
-  */
-  std::cout << "\n--------------------------------------------------------------------------------------------\n";
 
-  flowMonitor->SerializeToXmlFile (file_path, false, true);
+  if (flowStatsFormat == "xml"){
+    flowStats->WriteXml (file_path + ".xml");
+  }else if (flowStatsFormat == "bin"){
+    flowStats->WriteBinary (file_path + ".bin");
+  }
 
   // Define variables to calculate the metrics
-  int k=0;
-  int totaltxPackets = 0;
-  int totalrxPackets = 0;
-  int totaltxPacketsR = 0;
-  int totalrxPacketsR = 0;
-  double totaltxbytes = 0;
-  double totalrxbytes = 0;
-  double totaltxbytesR = 0;
-  double totalrxbytesR = 0;
+  uint64_t totaltxPackets = 0;
+  uint64_t totalrxPackets = 0;
   double totaldelay = 0;
   double totalrxbitrate = 0;
   double difftx, diffrx;
   double pdf_value, rxbitrate_value, txbitrate_value, delay_value;
   double pdf_total, rxbitrate_total, delay_total;
-  double RL_rx_pack, RL_tx_pack, RL_rx_bytes, RL_tx_bytes;
-  
 
-  flowMonitor->CheckForLostPackets();
-  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
-  std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats ();
-
-  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+  // Data flows, straight from the collector's counters
+  for (uint32_t i = 0; i < flowStats->GetN (); i++)
   {
-      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
-      difftx = i->second.timeLastTxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds();
-      diffrx = i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstRxPacket.GetSeconds();
-      pdf_value = (double) i->second.rxPackets / (double) i->second.txPackets * 100;
-      txbitrate_value = (double) i->second.txBytes * 8 / 1024 / difftx;
-      if (i->second.rxPackets != 0){
-          rxbitrate_value = (double) i->second.rxPackets * packet_size * 8 / 1024 / diffrx;
-          delay_value = (double) i->second.delaySum.GetSeconds() / (double) i->second.rxPackets;
+      const FlowSpec &f = flowStats->GetFlow (i);
+      const FlowCounters &c = flowStats->Get (i);
+      difftx = TimeStep (c.lastTx - c.firstTx).GetSeconds ();
+      diffrx = TimeStep (c.lastRx - c.firstRx).GetSeconds ();
+      pdf_value = c.txPackets != 0 ? (double) c.rxPackets / (double) c.txPackets * 100 : 0;
+      txbitrate_value = difftx > 0 ? (double) c.txBytes * 8 / 1024 / difftx : 0;
+      if (c.rxPackets != 0 && diffrx > 0){
+          rxbitrate_value = (double) c.rxPackets * packet_size * 8 / 1024 / diffrx;
       }
       else{
           rxbitrate_value = 0;
-          delay_value = 0;
       }
-      
-      // We are only interested in the metrics of the data flows. This AODV
-      // implementation create other flows with routing information at low bitrates,
-      // so a margin is defined to ensure that only our data flows are filtered.
-      if ( (!t.destinationAddress.IsSubnetDirectedBroadcast("255.255.255.0")) && (txbitrate_value > 150/1.2) && (rxbitrate_value < 150*1.2))
-      {
-          k++;
-          std::cout << "\nFlow " << k << " (" << t.sourceAddress << " -> "
-          << t.destinationAddress << ")\n";
-          //std::cout << "Tx Packets: " << i->second.txPackets << "\n";
-          //std::cout << "Rx Packets: " << i->second.rxPackets << "\n";
-          //std::cout << "Lost Packets: " << i->second.lostPackets << "\n";
-          //std::cout << "Dropped Packets: " << i->second.packetsDropped.size() << "\n";
-          std::cout << "PDF: " << pdf_value << " %\n";
-          std::cout << "Average delay: " << delay_value << "s\n";
-          std::cout << "Rx bitrate: " << rxbitrate_value << " kbps\n";
-          std::cout << "Tx bitrate: " << txbitrate_value << " kbps\n\n";
-          // Acumulate for average statistics
-          totaltxPackets += i->second.txPackets;
-          totaltxbytes += i->second.txBytes;
-          totalrxPackets += i->second.rxPackets;
-          totaldelay += i->second.delaySum.GetSeconds();
-          totalrxbitrate += rxbitrate_value;
-          totalrxbytes += i->second.rxBytes;
+      delay_value = c.rxPackets != 0 ? TimeStep (c.delaySum).GetSeconds () / (double) c.rxPackets : 0;
+
+      if (c.txPackets != 0){
+        eventLog->AddAt (TimeStep (c.firstTx), EVENT_APP_START, i, f.source);
+        eventLog->AddAt (TimeStep (c.lastTx), EVENT_APP_STOP, i, f.source);
       }
-      else{
-          totaltxbytesR += i->second.txBytes;
-          totalrxbytesR += i->second.rxBytes;
-          totaltxPacketsR += i->second.txPackets;
-          totalrxPacketsR += i->second.rxPackets;
+      if (c.rxPackets != 0){
+        eventLog->AddAt (TimeStep (c.firstRx), EVENT_ROUTE_FOUND, i, f.source, f.sink,
+                         TimeStep (c.firstRx - c.firstTx).GetSeconds ());
+      }
+      eventLog->Add (EVENT_FLOW_RESULT, i, f.source, f.sink, pdf_value, delay_value, rxbitrate_value, txbitrate_value);
+      if (verbose){
+        std::cout << "\nFlow " << i + 1 << " (" << interfaces.GetAddress (f.source) << " -> "
+        << interfaces.GetAddress (f.sink) << ")\n";
+        std::cout << "PDF: " << pdf_value << " %\n";
+        std::cout << "Average delay: " << delay_value << "s\n";
+        std::cout << "Rx bitrate: " << rxbitrate_value << " kbps\n";
+        std::cout << "Tx bitrate: " << txbitrate_value << " kbps\n\n";
       }
+      // Acumulate for average statistics
+      totaltxPackets += c.txPackets;
+      totalrxPackets += c.rxPackets;
+      totaldelay += TimeStep (c.delaySum).GetSeconds ();
+      totalrxbitrate += rxbitrate_value;
   }
 
+  // Routing load: control traffic per data packet or byte, at the IP layer
+  if (flowmon){
+    flowMonitor->CheckForLostPackets();
+    flowMonitor->SerializeToXmlFile ("xml/flowmonitor/flowmonitor-" + std::to_string(connections) + outputSuffix + ".xml", false, false);
+  }
+  if (hopSampler){
+    hopSampler->WriteCsv ("xml/flowmonitor/hops-" + std::to_string(connections) + outputSuffix + ".csv",
+                          "xml/flowmonitor/relays-" + std::to_string(connections) + outputSuffix + ".csv");
+  }
+  double totaltxPacketsD = traffic->GetTxPackets (TrafficCounters::DATA);
+  double totalrxPacketsD = traffic->GetRxPackets (TrafficCounters::DATA);
+  double totaltxbytesD = traffic->GetTxBytes (TrafficCounters::DATA);
+  double totalrxbytesD = traffic->GetRxBytes (TrafficCounters::DATA);
+  double totaltxPacketsR = traffic->GetTxPackets (TrafficCounters::CONTROL);
+  double totalrxPacketsR = traffic->GetRxPackets (TrafficCounters::CONTROL);
+  double totaltxbytesR = traffic->GetTxBytes (TrafficCounters::CONTROL);
+  double totalrxbytesR = traffic->GetRxBytes (TrafficCounters::CONTROL);
+  double RL_rx_pack, RL_tx_pack, RL_rx_bytes, RL_tx_bytes;
+
+  // SendOutgoing fires before traffic control sees a packet, so the RREQ
+  // rebroadcasts that aodv-cond suppressed were never on the air
+  uint64_t suppressedPackets, suppressedBytes;
+  routing.GetSuppressedRreqs (suppressedPackets, suppressedBytes);
+  totaltxPacketsR -= suppressedPackets;
+  totaltxbytesR -= suppressedBytes;
+
   //Average all nodes statistics
   if (totaltxPackets != 0){
       pdf_total = (double) totalrxPackets / (double) totaltxPackets * 100;
-      RL_tx_pack = (double) totaltxPacketsR / (double) totaltxPackets;
-      RL_tx_bytes = totaltxbytesR / totaltxbytes;
   }
   else{
       pdf_total = 0;
-      RL_tx_pack = 0;
-      RL_tx_bytes = 0;
   }
   if (totalrxPackets != 0){
       rxbitrate_total = totalrxbitrate;
       delay_total = (double) totaldelay / (double) totalrxPackets;
-      RL_rx_pack = (double) totalrxPacketsR / (double) totalrxPackets;
-      RL_rx_bytes = totalrxbytesR / totalrxbytes;
   }
   else{
       rxbitrate_total = 0;
       delay_total = 0;
+  }
+  if (totaltxPacketsD != 0){
+      RL_tx_pack = (double) totaltxPacketsR / (double) totaltxPacketsD;
+      RL_tx_bytes = totaltxbytesR / totaltxbytesD;
+  }
+  else{
+      RL_tx_pack = 0;
+      RL_tx_bytes = 0;
+  }
+  if (totalrxPacketsD != 0){
+      RL_rx_pack = (double) totalrxPacketsR / (double) totalrxPacketsD;
+      RL_rx_bytes = totalrxbytesR / totalrxbytesD;
+  }
+  else{
       RL_rx_pack = 0;
       RL_rx_bytes = 0;
   }
+  eventLog->Add (EVENT_ROUTING_LOAD, suppressedPackets, 0, 0, RL_tx_pack, RL_rx_pack, RL_tx_bytes, RL_rx_bytes);
+  eventLog->Add (EVENT_TOTAL, connections, 0, 0, pdf_total, rxbitrate_total, delay_total);
   // Print all nodes statistics
-  std::cout << "\nTotal PDF: " << pdf_total << " %\n";
-  std::cout << "Total Rx bitrate: " << rxbitrate_total << " kbps\n";
-  std::cout << "Total Delay: " << delay_total << " s\n";
+  if (verbose){
+    std::cout << "\nTotal PDF: " << pdf_total << " %\n";
+    std::cout << "Total Rx bitrate: " << rxbitrate_total << " kbps\n";
+    std::cout << "Total Delay: " << delay_total << " s\n";
+  }
+
+#ifdef VANETRC_PROFILE
+  std::cout << "\n------------------------------Event profile-------------------------------------------------\n\n";
+  ProfilingScheduler::GetCurrent ()->Print (std::cout, 10);
+  ProfilingScheduler::GetCurrent ()->WriteReport ("xml/flowmonitor/profile-" + std::to_string(connections) + outputSuffix + ".csv");
+#endif
+
+  if (!eventLog->Write ("xml/events-" + std::to_string(connections) + outputSuffix + ".bin",
+                        routing.GetProtocol (), size, connections, seed, packet_size)){
+    std::cerr << "Cannot write the event log\n";
+  }
 
-  // file pointer 
-  std::fstream fout; 
-  // opens an existing csv file or creates a new file. 
-  fout.open("xml/VanetRC-report.csv", std::ios::out | std::ios::app);
-  fout << connections << "," << seed << "," << pdf_total << "," << rxbitrate_total << "\n";
+  RunResult result;
+  std::memset (&result, 0, sizeof (result));
+  std::strncpy (result.routing, routing.GetProtocol ().c_str (), sizeof (result.routing) - 1);
+  result.connections = connections;
+  result.seed = seed;
+  result.size = size;
+  result.dataRate = DataRate (dataRate).GetBitRate ();
+  result.pdf = pdf_total;
+  result.rxBitrate = rxbitrate_total;
+  result.delay = delay_total;
+  result.rlTxPackets = RL_tx_pack;
+  result.rlRxPackets = RL_rx_pack;
+  result.rlTxBytes = RL_tx_bytes;
+  result.rlRxBytes = RL_rx_bytes;
+  result.events = Simulator::GetEventCount ();
+  result.setupSeconds = setupSeconds;
+  result.devicesSeconds = devicesSeconds;
+  result.stackSeconds = stackSeconds;
+  result.runSeconds = runSeconds;
+  result.statsSeconds = secondsSince (phase);
 
+  phase = std::chrono::steady_clock::now ();
   Simulator::Destroy ();
+  result.teardownSeconds = secondsSince (phase);
+
+  result.wallSeconds = secondsSince (wallStart);
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  result.peakRssKb = usage.ru_maxrss;
+  return result;
+};
+
+bool
+RoutingExample::writeReport(const RunResult &r){
+  // Locked appends, so concurrent sweeps can share a store
+  std::string error;
+  bool stored = true;
+  if (!ResultsStore (resultsFile).Append (r, error)){
+    std::cerr << "Cannot store the results: " << error << "\n";
+    stored = false;
+  }
+  if (!benchReport.empty() && !ResultsStore (benchReport).Append (r, error)){
+    std::cerr << "Cannot store the results: " << error << "\n";
+    stored = false;
+  }
+  return stored;
+};
+
+int
+RoutingExample::runSweep(){
+  // Adaptive replication draws from up to 100 seeds unless told otherwise
+  std::string seedList = sweepSeeds;
+  if (seedList.empty()){
+    seedList = targetCi > 0 ? std::to_string(seed) + ":" + std::to_string(seed + 99) : std::to_string(seed);
+  }
+  std::vector<uint32_t> seeds = SweepRunner::ParseList(seedList);
+  std::vector<uint32_t> conns = SweepRunner::ParseList(sweepConnections.empty() ? std::to_string(connections) : sweepConnections);
+  std::vector<SweepJob> sweep = SweepRunner::MakeJobs(conns, seeds);
+  NS_ABORT_MSG_IF (sweep.empty(), "Nothing to sweep: no valid seed or connection count");
+
+  SweepRunner runner(jobs);
+  runner.SetLogPattern("xml/sweep-c%c-s%s.log");
+  std::cout << "Sweep: " << sweep.size() << " replications on " << runner.GetWorkers() << " workers\n";
+
+  ReplicationController controller(targetCi, ciLevel, minSeeds);
+  if (targetCi > 0){
+    controller.SetJobs(sweep);
+    runner.SetSkipCallback([&controller](uint32_t job) { return controller.Skip(job); });
+    runner.SetResultCallback([&controller](uint32_t job, bool ok, const RunResult &r) { controller.Add(job, ok, r); });
+    std::cout << "Adaptive: at least " << minSeeds << " seeds, until the " << ciLevel * 100
+              << " % confidence intervals are within " << targetCi * 100 << " % of the means\n";
+  }
+
+  if (warmup > 0){
+    std::cout << "Warm start: simulating the first " << warmup << " s once\n";
+    warmUp();
+  }
+
+  // Workers are forked, so each one changes and runs its own copy of this
+  std::vector<RunResult> results;
+  std::vector<bool> done;
+  bool ok = runner.Run(sweep, [this](const SweepJob &job) {
+      connections = job.connections;
+      seed = job.seed;
+      outputSuffix = "-c" + std::to_string(job.connections) + "-s" + std::to_string(job.seed);
+      if (warmup > 0){
+        wallStart = std::chrono::steady_clock::now ();
+        return finishRun();
+      }
+      return run();
+    }, results, done);
+
+  // Only the parent writes the report, in sweep order
+  for (uint32_t i = 0; i < results.size(); i++)
+  {
+    if (done[i] && (targetCi <= 0 || controller.IsKept(i)) && !writeReport(results[i])) ok = false;
+  }
+  if (targetCi > 0){
+    controller.Print(std::cout);
+  }
+  return ok ? 0 : 1;
 };
 
 void RoutingExample::configuration(int argc, char ** argv){
   CommandLine cmd;
   cmd.AddValue("size", "Number of nodes", size);
+  cmd.AddValue("grid-width", "Columns of the static node grid, 0 for ceil(sqrt(size))", gridWidth);
   cmd.AddValue("seed", "Value of seed", seed);
   cmd.AddValue("connections", "Number of connections", connections);
+  cmd.AddValue("data-rate", "Data rate of each flow", dataRate);
+  cmd.AddValue("traffic", "Flow sender: onoff (an application per flow) or cbr (one timer wheel, batched sends)", trafficMode);
+  cmd.AddValue("cbr-slot", "Seconds per slot of the --traffic=cbr timer wheel", cbrSlot);
+  cmd.AddValue("sweep-seeds", "Seeds of a sweep, e.g. 1:100 or 1,2,3", sweepSeeds);
+  cmd.AddValue("sweep-connections", "Connection counts of a sweep, e.g. 5,10,15,20", sweepConnections);
+  cmd.AddValue("target-ci", "Stop seeding a connection count once the confidence intervals of PDF, delay and rx bitrate are within this fraction of their means (0 = run every seed)", targetCi);
+  cmd.AddValue("ci-level", "Confidence level of --target-ci", ciLevel);
+  cmd.AddValue("min-seeds", "Seeds run before --target-ci is tested", minSeeds);
+  cmd.AddValue("jobs", "Worker processes of a sweep (0 = one per core)", jobs);
+  cmd.AddValue("channel", "Wifi channel, yans or grid (spatially culled, for large --size)", channel);
+  cmd.AddValue("static-topology", "Cache the gain and delay of every node pair (constant-position nodes only)", staticTopology);
+  cmd.AddValue("trace-file", "Binary vehicle trace to replay instead of the static grid", traceFile);
+  cmd.AddValue("warmup", "Simulate the first seconds of a sweep once and fork the replications from there", warmup);
+  cmd.AddValue("routing", "Routing protocol: aodv, aodv-cond, olsr, dsdv or dsr", routingName);
+  cmd.AddValue("pcap", "Write one pcap file per node and interface (off with --capture)", pcap);
+  cmd.AddValue("capture", "Merged capture of all, data or control packets to xml/pcap/capture*.pcap", capture);
+  cmd.AddValue("capture-nodes", "Nodes to capture (\"0:9\", \"3,7\"), all if empty", captureNodes);
+  cmd.AddValue("snaplen", "Bytes kept of each captured packet", snapLen);
+  cmd.AddValue("anim", "Write the full NetAnim trace of the first 10 s to xml/test.xml", anim);
+  cmd.AddValue("anim-light", "Write a decimated NetAnim trace of the whole run to xml/vanetrc-anim*.xml.gz", animLight);
+  cmd.AddValue("anim-poll", "Seconds between position checks of --anim-light", animPoll);
+  cmd.AddValue("anim-min-move", "Meters a node must move for --anim-light to write its position", animMinMove);
+  cmd.AddValue("anim-sample", "--anim-light draws one packet in this many", animSample);
+  cmd.AddValue("route-interval", "Record the routing tables to xml/routes*.bin, a diff every this many seconds, instead of the text dumps", routeInterval);
+  cmd.AddValue("sample-interval", "Record the rx bytes of every flow and node every this many seconds to xml/throughput-*.bin", sampleInterval);
+  cmd.AddValue("flowmon", "Also install FlowMonitor and write xml/flowmonitor/flowmonitor-*.xml", flowmon);
+  cmd.AddValue("flowmon-probes", "Nodes --flowmon probes: endpoints (flow sources and sinks) or all", flowmonProbes);
+  cmd.AddValue("hop-sample", "Follow one data packet in this many hop by hop, to xml/flowmonitor/hops-*.csv and relays-*.csv (0 for none)", hopSample);
+  cmd.AddValue("verbose", "Print the flow set up and results as text; they are always logged to xml/events-*.bin", verbose);
+  cmd.AddValue("flow-stats", "Write the per-flow counters to xml/flowmonitor: none, bin or xml", flowStatsFormat);
+  cmd.AddValue("auto-stop", "Stop once every data flow has ended and no data packet is in flight, plus --drain", autoStop);
+  cmd.AddValue("drain", "Seconds simulated after quiescence with --auto-stop", drain);
+  cmd.AddValue("flow-file", "Flow list, one \"source sink start stop\" line per flow, instead of --connections random flows", flowFile);
+  cmd.AddValue("results", "Results store every replication is appended to", resultsFile);
+  cmd.AddValue("bench-report", "Also append the results to this store", benchReport);
   cmd.Parse (argc, argv);
+  NS_ABORT_MSG_UNLESS (routing.SetProtocol (routingName), "Unknown routing protocol " << routingName);
+  NS_ABORT_MSG_IF (DataRate (dataRate).GetBitRate () == 0, "--data-rate must be positive");
+  data_rate = StringValue (dataRate);
+  NS_ABORT_MSG_IF (drain < 0, "--drain must not be negative");
+  NS_ABORT_MSG_UNLESS (trafficMode == "onoff" || trafficMode == "cbr", "--traffic must be onoff or cbr");
+  NS_ABORT_MSG_UNLESS (channel == "yans" || channel == "grid", "--channel must be yans or grid");
+  NS_ABORT_MSG_IF (cbrSlot <= 0, "--cbr-slot must be positive");
+  NS_ABORT_MSG_IF (targetCi < 0 || ciLevel <= 0 || ciLevel >= 1, "--target-ci must not be negative and --ci-level must be in (0, 1)");
+  NS_ABORT_MSG_IF (minSeeds < 2, "--min-seeds must be at least 2");
+  NS_ABORT_MSG_IF (warmup < 0, "--warmup must not be negative");
+  if (warmup > 0){
+    // Checked before the parent simulates the shared prefix for every job
+    double firstStart = 15; // generateFlows() starts every flow at 15 s
+    if (!flowFile.empty()){
+      FlowTable fileFlows;
+      std::string error;
+      NS_ABORT_MSG_UNLESS (fileFlows.Load (flowFile, size, error), error);
+      for (uint32_t i = 0; i < fileFlows.GetN(); i++){
+        firstStart = i == 0 ? fileFlows.Get(i).start : std::min (firstStart, fileFlows.Get(i).start);
+      }
+    }
+    NS_ABORT_MSG_IF (warmup > firstStart, "--warmup must not pass the first data start (" << firstStart << " s)");
+  }
+  PcapCapture::Filter filter;
+  NS_ABORT_MSG_UNLESS (capture.empty() || PcapCapture::ParseFilter (capture, filter), "--capture must be all, data or control");
+  NS_ABORT_MSG_IF (snapLen == 0, "--snaplen must be positive");
+  NS_ABORT_MSG_IF (animPoll <= 0 || animSample == 0, "--anim-poll and --anim-sample must be positive");
+  NS_ABORT_MSG_UNLESS (flowStatsFormat == "none" || flowStatsFormat == "bin" || flowStatsFormat == "xml",
+                       "--flow-stats must be none, bin or xml");
+  NS_ABORT_MSG_UNLESS (flowmonProbes == "endpoints" || flowmonProbes == "all", "--flowmon-probes must be endpoints or all");
 }
 
 void
@@ -351,15 +793,30 @@ RoutingExample::createNodes(int i){
   //Creating nodes
   nodes.Create(i);
 
+  if (!traceFile.empty()){
+    // Node k replays vehicle k of the trace
+    vehicleTrace = Create<VehicleTrace> ();
+    NS_ABORT_MSG_UNLESS (vehicleTrace->Open (traceFile), "Cannot read vehicle trace " << traceFile);
+    NS_ABORT_MSG_IF (vehicleTrace->GetVehicles () < nodes.GetN (), "The trace only has " << vehicleTrace->GetVehicles () << " vehicles");
+    for (uint32_t k = 0; k < nodes.GetN (); k++){
+      Ptr<TraceMobilityModel> model = CreateObject<TraceMobilityModel> ();
+      model->SetTrace (vehicleTrace, k);
+      nodes.Get (k)->AggregateObject (model);
+    }
+    return;
+  }
+
   //Adding Mobility to the created nodes
   MobilityHelper mobility;
 
+  // gridWidth columns, or a square grid so that large sizes stay a mesh
+  uint32_t width = gridWidth > 0 ? gridWidth : (uint32_t) std::ceil (std::sqrt ((double) i));
   mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
   "MinX", DoubleValue (0.0),
   "MinY", DoubleValue (0.0),
   "DeltaX", DoubleValue (150),
   "DeltaY", DoubleValue (150),
-  "GridWidth", UintegerValue (5),
+  "GridWidth", UintegerValue (width),
   "LayoutType", StringValue ("RowFirst"));
 
   //mobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
@@ -374,21 +831,68 @@ void
 RoutingExample::createDevices(){
   WifiMacHelper wifiMac;
   wifiMac.SetType ("ns3::AdhocWifiMac");
-  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiPhyHelper yansPhy = YansWifiPhyHelper::Default ();
+  SpectrumWifiPhyHelper spectrumPhy = SpectrumWifiPhyHelper::Default ();
+  WifiPhyHelper &wifiPhy = (channel == "grid") ? static_cast<WifiPhyHelper &> (spectrumPhy) : yansPhy;
   YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  // Link budget of the phys, dBm and dB
+  double txPower = 30, txGain = 1.0, rxGain = 1.0, rxSensitivity = -89.0;
 
   wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
   //wifiChannel.AddPropagationLoss ("ns3::LogDistancePropagationLossModel","Exponent", StringValue ("2.7"));
 
-  wifiPhy.Set ("RxSensitivity", DoubleValue (-89.0) );
+  wifiPhy.Set ("RxSensitivity", DoubleValue (rxSensitivity) );
   wifiPhy.Set ("CcaEdThreshold", DoubleValue (-62.0) );
-  wifiPhy.Set ("TxGain", DoubleValue (1.0) );
-  wifiPhy.Set ("RxGain", DoubleValue (1.0) );
+  wifiPhy.Set ("TxGain", DoubleValue (txGain) );
+  wifiPhy.Set ("RxGain", DoubleValue (rxGain) );
   wifiPhy.Set ("TxPowerLevels", UintegerValue (1) );
-  wifiPhy.Set ("TxPowerEnd", DoubleValue (30) );
-  wifiPhy.Set ("TxPowerStart", DoubleValue (30) );
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (txPower) );
+  wifiPhy.Set ("TxPowerStart", DoubleValue (txPower) );
   wifiPhy.Set ("RxNoiseFigure", DoubleValue (7.0) );
-  wifiPhy.SetChannel (wifiChannel.Create ());
+
+  // Same loss and delay models as YansWifiChannelHelper::Default
+  Ptr<PropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  double range = GridSpectrumChannel::RangeForLoss (loss, txPower + txGain + rxGain - rxSensitivity);
+  bool cached = false;
+  if (staticTopology){
+    // Nodes are placed by now, so every pair's gain and delay is known
+    Ptr<LinkBudgetCache> cache = Create<LinkBudgetCache> (loss, delay);
+    cached = cache->Build (nodes);
+    if (cached){
+      Ptr<CachedPropagationLossModel> cachedLoss = CreateObject<CachedPropagationLossModel> ();
+      Ptr<CachedPropagationDelayModel> cachedDelay = CreateObject<CachedPropagationDelayModel> ();
+      cachedLoss->SetCache (cache);
+      cachedDelay->SetCache (cache);
+      loss = cachedLoss;
+      delay = cachedDelay;
+    }
+    else{
+      std::cout << "Static topology cache disabled: not every node is constant-position\n";
+    }
+  }
+
+  if (channel == "grid"){
+    // Only the phys within decodable range of the sender get the frame
+    Ptr<GridSpectrumChannel> gridChannel = CreateObject<GridSpectrumChannel> ();
+    gridChannel->AddPropagationLossModel (loss);
+    gridChannel->SetPropagationDelayModel (delay);
+    gridChannel->SetAttribute ("MaxRange", DoubleValue (range));
+    if (vehicleTrace){
+      // Trace positions move without CourseChange notifications
+      gridChannel->SetAttribute ("MaxSpeed", DoubleValue (vehicleTrace->GetMaxSpeed ()));
+    }
+    spectrumPhy.SetChannel (gridChannel);
+  }
+  else if (cached){
+    Ptr<YansWifiChannel> yansChannel = CreateObject<YansWifiChannel> ();
+    yansChannel->SetPropagationLossModel (loss);
+    yansChannel->SetPropagationDelayModel (delay);
+    yansPhy.SetChannel (yansChannel);
+  }
+  else{
+    yansPhy.SetChannel (wifiChannel.Create ());
+  }
   
   WifiHelper wifi;
   wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
@@ -404,13 +908,13 @@ RoutingExample::createDevices(){
 void
 RoutingExample::installInternetStack(){
   
-  routing.Set ("AllowedHelloLoss", UintegerValue (20));
-  routing.Set ("HelloInterval", TimeValue (Seconds (3)));
-  routing.Set ("RreqRetries", UintegerValue (5));
-  routing.Set ("ActiveRouteTimeout", TimeValue (Seconds (100)));
-  routing.Set ("DestinationOnly", BooleanValue (true));
-  stack.SetRoutingHelper (routing); // has effect on the next Install ()
-  stack.Install (nodes);
+  AodvHelper &aodv = routing.GetAodv ();
+  aodv.Set ("AllowedHelloLoss", UintegerValue (20));
+  aodv.Set ("HelloInterval", TimeValue (Seconds (3)));
+  aodv.Set ("RreqRetries", UintegerValue (5));
+  aodv.Set ("ActiveRouteTimeout", TimeValue (Seconds (100)));
+  aodv.Set ("DestinationOnly", BooleanValue (true));
+  routing.Install (stack, nodes);
   Ipv4AddressHelper address;
   address.SetBase ("10.0.0.0", "255.0.0.0");
   interfaces = address.Assign (devices);
@@ -441,10 +945,8 @@ RoutingExample::installApplications(){
 };
 */
 
-void 
-RoutingExample::installOnOffApplications(){
-
-  RngSeedManager::SetSeed(seed);
+void
+RoutingExample::generateFlows(){
 
   double start_time, stop_time, duration;
 
@@ -456,13 +958,16 @@ RoutingExample::installOnOffApplications(){
   rand_nodes->SetAttribute("Min", DoubleValue (0));
   rand_nodes->SetAttribute("Max", DoubleValue(size-1));
 
-  ApplicationContainer apps [connections];
+  // Created after rand_nodes, so a seed still picks the same endpoints
+  Ptr<ExponentialRandomVariable> b = CreateObject<ExponentialRandomVariable>();
+  b->SetAttribute("Mean", DoubleValue(30));
+
+  flows.Clear();
+  flows.Reserve(connections);
   for (uint32_t i = 0; i < connections; i++)
   {
 
     start_time = a->GetValue();
-    Ptr<ExponentialRandomVariable> b = CreateObject<ExponentialRandomVariable>();
-    b->SetAttribute("Mean", DoubleValue(30));
     duration = b->GetValue()+1;
 
     if ( (start_time + duration) > (totalTime - 10)){
@@ -481,66 +986,125 @@ RoutingExample::installOnOffApplications(){
       client_node = rand_nodes->GetInteger (0,size-1);
     }
 
-    std::cout << "\n Packet Flow: \t\t" << client_node << " to " << server_node;
-    std::cout << "\n Start_time: \t\t" << start_time << "s";
-    std::cout << "\n Stop_time: \t\t" << stop_time << "s\n";
+    FlowSpec flow = {client_node, server_node, start_time, stop_time};
+    flows.Add(flow);
+  }
+};
 
-    OnOffHelper onoff ("ns3::UdpSocketFactory", Address (InetSocketAddress(interfaces.GetAddress (server_node), 9)));
-    onoff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
-    onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));;
-    onoff.SetAttribute ("PacketSize", UintegerValue(packet_size));
-    onoff.SetAttribute ("DataRate", data_rate);
-    
-    apps[i] = onoff.Install (nodes.Get(client_node));
-    apps[i].Start (Seconds (start_time));
-    apps[i].Stop (Seconds (stop_time));
-    /*
-    // Create a packet sink to receive the packets
-    PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress(interfaces.GetAddress (server_node), 9));
-    apps[i] = sinkHelper.Install (nodes.Get(server_node));
-    sink[i] = StaticCast<PacketSink> (apps[i].Get(0));
-    apps[i].Start(Seconds (start_time));
-    apps[i].Stop(Seconds(stop_time));
-    */
+void
+RoutingExample::installOnOffApplications(){
+
+  RngSeedManager::SetSeed(seed);
+
+  if (flowFile.empty()){
+    generateFlows();
+  }else{
+    std::string error;
+    NS_ABORT_MSG_UNLESS (flows.Load (flowFile, size, error), error);
+    connections = flows.GetN();
+  }
+
+  // One helper for every flow, only the remote address changes
+  OnOffHelper onoff ("ns3::UdpSocketFactory", Address ());
+  onoff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+  onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  onoff.SetAttribute ("PacketSize", UintegerValue(packet_size));
+  onoff.SetAttribute ("DataRate", data_rate);
+  // One sink per destination node receives every flow to port 9
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  std::vector<bool> hasSink (size, false);
+  sinks.clear();
+  flowStats = Create<FlowStatsCollector> (flows);
+  traffic->SetFlows (flows);
+  if (trafficMode == "cbr"){
+    cbr = Create<CbrGenerator> (packet_size, DataRate (dataRate), Seconds (cbrSlot));
+    cbr->SetCollector (flowStats);
+  }
+
+  for (uint32_t i = 0; i < flows.GetN(); i++)
+  {
+    const FlowSpec &flow = flows.Get(i);
+    NS_ABORT_MSG_IF (Seconds (flow.start) < Simulator::Now (), "Flow " << i << " starts before the warm-up point");
+    vehicleStates->AddFlow(flow.source, flow.sink);
+
+    eventLog->Add (EVENT_FLOW_SETUP, i, flow.source, flow.sink, flow.start, flow.stop);
+    if (verbose){
+      std::cout << "\n Packet Flow: \t\t" << flow.source << " to " << flow.sink;
+      std::cout << "\n Start_time: \t\t" << flow.start << "s";
+      std::cout << "\n Stop_time: \t\t" << flow.stop << "s\n";
+    }
+
+    InetSocketAddress remote (interfaces.GetAddress (flow.sink), 9);
+    if (cbr){
+      cbr->AddFlow (i, nodes.Get(flow.source), remote, Seconds (flow.start), Seconds (flow.stop));
+    }else{
+      // Application times count from the install time, which is the
+      // warm-up point when the replication was forked from a warm start
+      onoff.SetAttribute ("Remote", AddressValue (remote));
+      Ptr<Application> app = onoff.Install (nodes.Get(flow.source)).Get (0);
+      app->SetStartTime (Seconds (flow.start) - Simulator::Now ());
+      app->SetStopTime (Seconds (flow.stop) - Simulator::Now ());
+      flowStats->ConnectSource (i, app);
+    }
+
+    if (!hasSink[flow.sink]){
+      hasSink[flow.sink] = true;
+      sinks.push_back (StaticCast<PacketSink> (sinkHelper.Install (nodes.Get(flow.sink)).Get (0)));
+      flowStats->ConnectSink (sinks.back ());
+    }
   }
 
 };
 
 void
 RoutingExample::printingRoutingTable(){
-  Time rtt1 = Seconds(15.0);
+  Time rtt1 = Seconds(15.0) - Simulator::Now ();
   AsciiTraceHelper ascii1;
-  Ptr<OutputStreamWrapper> rtw1 = ascii1.CreateFileStream ("xml/routing_table1");
+  Ptr<OutputStreamWrapper> rtw1 = ascii1.CreateFileStream ("xml/routing_table1" + outputSuffix);
   routing.PrintRoutingTableAllAt(rtt1,rtw1);
+  Simulator::Schedule (rtt1, &RoutingExample::logRouteDump, this, 1);
 
-  Time rtt2 = Seconds(16.0);
+  Time rtt2 = Seconds(16.0) - Simulator::Now ();
   AsciiTraceHelper ascii2;
-  Ptr<OutputStreamWrapper> rtw2 = ascii2.CreateFileStream ("xml/routing_table2");
+  Ptr<OutputStreamWrapper> rtw2 = ascii2.CreateFileStream ("xml/routing_table2" + outputSuffix);
   routing.PrintRoutingTableAllAt(rtt2,rtw2);
+  Simulator::Schedule (rtt2, &RoutingExample::logRouteDump, this, 2);
   
-  Time rtt3 = Seconds(30.0);
+  Time rtt3 = Seconds(30.0) - Simulator::Now ();
   AsciiTraceHelper ascii3;
-  Ptr<OutputStreamWrapper> rtw3 = ascii3.CreateFileStream ("xml/routing_table3");
+  Ptr<OutputStreamWrapper> rtw3 = ascii3.CreateFileStream ("xml/routing_table3" + outputSuffix);
   routing.PrintRoutingTableAllAt(rtt3,rtw3);
+  Simulator::Schedule (rtt3, &RoutingExample::logRouteDump, this, 3);
 };
 
+void
+RoutingExample::logRouteDump(uint32_t dump){
+  eventLog->Add (EVENT_ROUTE_DUMP, dump);
+}
+
 void
 RoutingExample::enablePcapTracing(){
-  stack.EnablePcapIpv4All ("xml/pcap/internet"); // gets pcap files of all nodes
+  stack.EnablePcapIpv4All ("xml/pcap/internet" + outputSuffix); // gets pcap files of all nodes
 }
 
-/*
 void
-RoutingExample::calculateThroughput(){
-  
-  Time now = Simulator::Now ();                                               // Return the simulator's virtual time.
-  double cur = (sink[0]->GetTotalRx () - lastTotalRx) * (double) 8 / 1e5;     // Convert Application RX Packets to MBits.
-  std::cout << now.GetSeconds () << "s: \t" << cur << " Mbit/s" << std::endl;
-  lastTotalRx = sink[0]->GetTotalRx ();
-  //Simulator::Schedule (MilliSeconds (100), &RoutingExample::calculateThroughput);
-  
+RoutingExample::enableCapture(){
+  PcapCapture::Filter filter;
+  PcapCapture::ParseFilter (capture, filter);
+  pcapCapture = Create<PcapCapture> (filter, snapLen);
+  NS_ABORT_MSG_UNLESS (pcapCapture->Open ("xml/pcap/capture" + outputSuffix + ".pcap"), "Cannot create the capture file");
+  if (captureNodes.empty()){
+    for (uint32_t i = 0; i < nodes.GetN (); i++){
+      pcapCapture->Install (nodes.Get (i));
+    }
+  }else{
+    std::vector<uint32_t> ids = SweepRunner::ParseList (captureNodes);
+    for (uint32_t i = 0; i < ids.size (); i++){
+      NS_ABORT_MSG_IF (ids[i] >= nodes.GetN (), "No node " << ids[i] << " to capture");
+      pcapCapture->Install (nodes.Get (ids[i]));
+    }
+  }
 }
-*/
 
 int
 main (int argc, char *argv[])
@@ -548,6 +1112,9 @@ main (int argc, char *argv[])
   
   RoutingExample app_RE;
   app_RE.configuration(argc, argv);
-  app_RE.run();
+  if (!app_RE.sweepSeeds.empty() || !app_RE.sweepConnections.empty() || app_RE.targetCi > 0){
+    return app_RE.runSweep();
+  }
+  return app_RE.writeReport(app_RE.run()) ? 0 : 1;
   
 }
\ No newline at end of file
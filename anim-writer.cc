@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "anim-writer.h"
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AnimWriter");
+
+AnimWriter::AnimWriter (Time poll, double minMove, uint32_t sampleEvery)
+  : m_poll (poll),
+    m_minMove2 (minMove * minMove),
+    m_sampleEvery (sampleEvery),
+    m_file (0),
+    m_pipe (false),
+    m_positionUpdates (0),
+    m_packets (0)
+{
+  NS_ASSERT (poll.IsStrictlyPositive () && sampleEvery > 0);
+}
+
+AnimWriter::~AnimWriter ()
+{
+  Stop ();
+}
+
+bool
+AnimWriter::Start (const std::string &path, const NodeContainer &nodes)
+{
+  NS_LOG_FUNCTION (this << path);
+  NS_ASSERT (m_file == 0);
+  m_pipe = path.size () > 3 && path.compare (path.size () - 3, 3, ".gz") == 0;
+  if (m_pipe)
+    {
+      m_file = popen (("gzip -c > '" + path + "'").c_str (), "w");
+    }
+  else
+    {
+      m_file = std::fopen (path.c_str (), "w");
+    }
+  if (m_file == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+
+  m_nodes = nodes;
+  m_x.resize (nodes.GetN ());
+  m_y.resize (nodes.GetN ());
+  double minX = 0, minY = 0, maxX = 0, maxY = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<MobilityModel> mobility = nodes.Get (i)->GetObject<MobilityModel> ();
+      Vector p = mobility ? mobility->GetPosition () : Vector ();
+      m_x[i] = p.x;
+      m_y[i] = p.y;
+      minX = i ? std::min (minX, p.x) : p.x;
+      minY = i ? std::min (minY, p.y) : p.y;
+      maxX = i ? std::max (maxX, p.x) : p.x;
+      maxY = i ? std::max (maxY, p.y) : p.y;
+    }
+  std::fprintf (m_file, "<anim ver=\"netanim-3.108\" filetype=\"animation\" >\n");
+  std::fprintf (m_file, "<topology minX=\"%g\" minY=\"%g\" maxX=\"%g\" maxY=\"%g\">\n", minX, minY, maxX, maxY);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      std::fprintf (m_file, "<node id=\"%u\" sysId=\"0\" locX=\"%g\" locY=\"%g\" />\n",
+                    nodes.Get (i)->GetId (), m_x[i], m_y[i]);
+    }
+  std::fprintf (m_file, "</topology>\n");
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4> ipv4 = nodes.Get (i)->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, "Node " << nodes.Get (i)->GetId () << " has no internet stack");
+      ipv4->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&AnimWriter::Tx, this, nodes.Get (i)->GetId ()));
+      ipv4->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&AnimWriter::Rx, this, nodes.Get (i)->GetId ()));
+    }
+  m_event = Simulator::Schedule (m_poll, &AnimWriter::Poll, this);
+  return true;
+}
+
+void
+AnimWriter::Stop (void)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  std::fprintf (m_file, "</anim>\n");
+  if (m_pipe)
+    {
+      pclose (m_file);
+    }
+  else
+    {
+      std::fclose (m_file);
+    }
+  m_file = 0;
+}
+
+void
+AnimWriter::Poll (void)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_nodes.Get (i)->GetObject<MobilityModel> ();
+      if (mobility == 0)
+        {
+          continue;
+        }
+      Vector p = mobility->GetPosition ();
+      double dx = p.x - m_x[i], dy = p.y - m_y[i];
+      if (dx * dx + dy * dy < m_minMove2)
+        {
+          continue;
+        }
+      m_x[i] = p.x;
+      m_y[i] = p.y;
+      std::fprintf (m_file, "<nu p=\"p\" t=\"%.3f\" id=\"%u\" x=\"%.2f\" y=\"%.2f\" />\n",
+                    now, m_nodes.Get (i)->GetId (), p.x, p.y);
+      m_positionUpdates++;
+    }
+  // A hop takes milliseconds; what was not received within a second never will be
+  for (std::unordered_map<uint64_t, Hop>::iterator i = m_pending.begin (); i != m_pending.end (); )
+    {
+      if (i->second.time < now - 1)
+        {
+          i = m_pending.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  m_event = Simulator::Schedule (m_poll, &AnimWriter::Poll, this);
+}
+
+bool
+AnimWriter::Sampled (Ptr<const Packet> packet) const
+{
+  return packet->GetUid () % m_sampleEvery == 0;
+}
+
+void
+AnimWriter::Tx (AnimWriter *writer, uint32_t node, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (writer->Sampled (packet))
+    {
+      Hop hop = { node, Simulator::Now ().GetSeconds () };
+      writer->m_pending[packet->GetUid ()] = hop;
+    }
+}
+
+void
+AnimWriter::Rx (AnimWriter *writer, uint32_t node, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (!writer->Sampled (packet))
+    {
+      return;
+    }
+  std::unordered_map<uint64_t, Hop>::const_iterator i = writer->m_pending.find (packet->GetUid ());
+  if (i == writer->m_pending.end () || i->second.node == node)
+    {
+      return;
+    }
+  // The hop is not erased here, so that every receiver of a broadcast is drawn
+  double now = Simulator::Now ().GetSeconds ();
+  std::fprintf (writer->m_file,
+                "<p fId=\"%u\" fbTx=\"%.6f\" lbTx=\"%.6f\" tId=\"%u\" fbRx=\"%.6f\" lbRx=\"%.6f\" />\n",
+                i->second.node, i->second.time, i->second.time, node, now, now);
+  writer->m_packets++;
+}
+
+uint64_t
+AnimWriter::GetPositionUpdates (void) const
+{
+  return m_positionUpdates;
+}
+
+uint64_t
+AnimWriter::GetPackets (void) const
+{
+  return m_packets;
+}
+
+} // namespace ns3
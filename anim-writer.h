@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_ANIM_WRITER_H
+#define VANETRC_ANIM_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4.h"
+
+namespace ns3 {
+
+/**
+ * A lightweight NetAnim trace for whole runs.
+ *
+ * Instead of AnimationInterface's packet metadata and per-poll updates,
+ * this writes the topology once, then a position update only for the nodes
+ * that moved more than minMove since their last written position, checked
+ * every poll interval, and one packet in sampleEvery: a sampled packet
+ * (chosen by uid, so it is followed along its whole path) is drawn for
+ * every IP hop it takes. A path ending in ".gz" is compressed on the fly
+ * through a gzip pipe.
+ */
+class AnimWriter : public SimpleRefCount<AnimWriter>
+{
+public:
+  AnimWriter (Time poll, double minMove, uint32_t sampleEvery);
+  ~AnimWriter ();
+
+  /**
+   * Open path, write the topology of nodes and start recording.
+   *
+   * \return false if path cannot be written
+   */
+  bool Start (const std::string &path, const NodeContainer &nodes);
+  /// Close the trace
+  void Stop (void);
+
+  /// Position updates and packets written so far
+  uint64_t GetPositionUpdates (void) const;
+  uint64_t GetPackets (void) const;
+
+private:
+  struct Hop
+  {
+    uint32_t node;
+    double time;
+  };
+
+  void Poll (void);
+  static void Tx (AnimWriter *writer, uint32_t node, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  static void Rx (AnimWriter *writer, uint32_t node, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  bool Sampled (Ptr<const Packet> packet) const;
+
+  Time m_poll;
+  double m_minMove2;
+  uint32_t m_sampleEvery;
+  NodeContainer m_nodes;
+  std::FILE *m_file;
+  bool m_pipe;
+  EventId m_event;
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  /// Last transmission of each sampled packet in flight, by uid
+  std::unordered_map<uint64_t, Hop> m_pending;
+  uint64_t m_positionUpdates;
+  uint64_t m_packets;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_ANIM_WRITER_H */
@@ -1,9 +1,9 @@
 #!/bin/sh
 # This is a comment!
 cd ../../
-for i in $(seq 1 1 10)
-do
-    #run VanetRC with different seed value (i)
-    echo "\t------ Seed Number: "$i" -------"
-    ./waf --run "VanetRC --seed="+$i+" --connections=5"
-done
\ No newline at end of file
+# run VanetRC with seed values 1..10, one worker process per core.
+# Every replication's text output goes to xml/sweep-c<connections>-s<seed>.log
+./waf --run "VanetRC --sweep-seeds=1:10 --sweep-connections=5"
+# Or run seeds from 1..100 only until the 95 % confidence intervals of PDF,
+# delay and rx bitrate are within 5 % of their means:
+# ./waf --run "VanetRC --sweep-seeds=1:100 --sweep-connections=5 --target-ci=0.05"
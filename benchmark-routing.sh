@@ -0,0 +1,22 @@
+#!/bin/sh
+# Runs every routing protocol over the same seeds and collects network
+# metrics and simulator cost (wall-clock, events, peak RSS) into one
+# results store.
+#   SEEDS="1:10" CONNECTIONS="5,10,15,20" JOBS=1 ./benchmark-routing.sh
+# JOBS=1 keeps the wall-clock times free of contention between workers.
+SEEDS=${SEEDS:-1:10}
+CONNECTIONS=${CONNECTIONS:-5,10,15,20}
+JOBS=${JOBS:-1}
+PROTOCOLS=${PROTOCOLS:-"aodv aodv-cond olsr dsdv dsr"}
+REPORT=xml/routing-benchmark.csv
+cd ../../
+rm -f $REPORT
+for p in $PROTOCOLS
+do
+    echo "\t------ Routing: "$p" -------"
+    ./waf --run "VanetRC --routing=$p --sweep-seeds=$SEEDS --sweep-connections=$CONNECTIONS --jobs=$JOBS --bench-report=$REPORT"
+done
+# Mean, confidence interval and percentiles of every metric per
+# (routing, connections, size)
+g++ -O2 -std=c++11 -o build/vanetrc-aggregate scratch/VanetRC/tools/vanetrc-aggregate.cc scratch/VanetRC/running-stats.cc
+build/vanetrc-aggregate $REPORT
@@ -0,0 +1,68 @@
+#!/bin/sh
+# Measures how the cost of a VanetRC run grows with the number of nodes,
+# connections and data rate under a fixed seed, and flags regressions
+# against a stored baseline.
+#   SIZES="25 100 500" RATES="150kb/s" ./benchmark-scaling.sh
+#   UPDATE_BASELINE=1 ./benchmark-scaling.sh    # accept the current numbers
+# Every run is one row of xml/scaling-bench.csv (a results store, see
+# results-store.h): wall time, events per second, peak RSS and the set up
+# (of which createDevices and installInternetStack), Simulator::Run, stats
+# post-pass and Simulator::Destroy times. Runs go one at a time so the times
+# are free of contention between workers. A run whose wall time or peak RSS
+# grew, or whose event rate fell, by more than TOLERANCE against the
+# baseline is flagged and makes the script exit with 1.
+SIZES=${SIZES:-"25 100 500 1000 5000"}
+CONNECTIONS=${CONNECTIONS:-5,20,50}
+RATES=${RATES:-"150kb/s 600kb/s"}
+SEED=${SEED:-1}
+# yans delivers every frame to every phy, which is quadratic in the size
+CHANNEL=${CHANNEL:-grid}
+TOLERANCE=${TOLERANCE:-0.15}
+REPORT=xml/scaling-bench.csv
+BASELINE=${BASELINE:-xml/scaling-baseline.csv}
+cd ../../
+rm -f $REPORT
+for n in $SIZES
+do
+    for r in $RATES
+    do
+        echo "\t------ Size: "$n", rate: "$r" -------"
+        ./waf --run "VanetRC --size=$n --data-rate=$r --sweep-seeds=$SEED --sweep-connections=$CONNECTIONS --jobs=1 --channel=$CHANNEL --grid-width=0 --pcap=false --results=$REPORT"
+    done
+done
+
+# Phases of every run; columns are looked up by name in the store's header
+awk -F, 'FNR == 2 { for (i = 1; i <= NF; i++) c[$i] = i; print "size,connections,rate,wall_s,events_per_s,peak_rss_kb,setup_s,devices_s,stack_s,run_s,stats_s,teardown_s"; next }
+         FNR > 2 { print $c["size"] "," $c["connections"] "," $c["rate"] "," $c["wall_s"] "," $c["events_per_s"] "," $c["peak_rss_kb"] "," \
+                         $c["setup_s"] "," $c["devices_s"] "," $c["stack_s"] "," $c["run_s"] "," $c["stats_s"] "," $c["teardown_s"] }' $REPORT
+
+if [ -n "$UPDATE_BASELINE" ]
+then
+    cp $REPORT $BASELINE
+    echo "Baseline saved to $BASELINE"
+    exit 0
+fi
+if [ ! -f $BASELINE ]
+then
+    echo "No baseline yet, UPDATE_BASELINE=1 saves this run as $BASELINE"
+    exit 0
+fi
+echo "routing,connections,size,rate,seed,metric,baseline,current,change,status"
+awk -F, -v tol=$TOLERANCE '
+    FNR == 1 { file++ }
+    FNR == 2 { delete c; for (i = 1; i <= NF; i++) c[$i] = i; next }
+    FNR < 3 { next }
+    { k = $c["routing"] "," $c["connections"] "," $c["size"] "," $c["rate"] "," $c["seed"] }
+    file == 1 { wall[k] = $c["wall_s"]; rate[k] = $c["events_per_s"]; rss[k] = $c["peak_rss_kb"]; next }
+    !(k in wall) { next }
+    { bad += check(k, "wall_s", wall[k], $c["wall_s"], 1)
+      bad += check(k, "events_per_s", rate[k], $c["events_per_s"], -1)
+      bad += check(k, "peak_rss_kb", rss[k], $c["peak_rss_kb"], 1) }
+    # sign 1: larger is worse, -1: smaller is worse
+    function check(k, metric, base, now, sign,    change, worse) {
+        change = base > 0 ? (now - base) / base : 0
+        worse = (sign * change > tol)
+        printf "%s,%s,%g,%g,%+.1f%%,%s\n", k, metric, base, now, change * 100, (worse ? "REGRESSION" : "ok")
+        return worse
+    }
+    END { if (bad) { print bad " regression(s) over " tol * 100 "%"; exit 1 } }' $BASELINE $REPORT
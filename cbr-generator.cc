@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "cbr-generator.h"
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-socket-factory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CbrGenerator");
+
+CbrGenerator::CbrGenerator (uint32_t packetSize, DataRate rate, Time slot)
+  : m_interval (rate.CalculateBytesTxTime (packetSize).GetTimeStep ()),
+    m_packetSize (packetSize),
+    m_nextTick (-1),
+    m_sent (0),
+    m_ticks (0)
+{
+  NS_ASSERT (m_interval > 0 && slot.IsStrictlyPositive ());
+  m_slot = std::min (slot.GetTimeStep (), m_interval);
+  // A flow's next send is at most ceil (interval / slot) slots ahead
+  m_wheel.resize (m_interval / m_slot + 2);
+  m_current = Simulator::Now ().GetTimeStep () / m_slot;
+}
+
+void
+CbrGenerator::SetCollector (Ptr<FlowStatsCollector> collector)
+{
+  m_collector = collector;
+}
+
+int64_t
+CbrGenerator::SlotOf (int64_t time) const
+{
+  return (time + m_slot - 1) / m_slot;
+}
+
+void
+CbrGenerator::AddFlow (uint32_t flow, Ptr<Node> source, const Address &remote, Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this << flow << start << stop);
+  Flow f;
+  f.id = flow;
+  f.next = start.GetTimeStep () + m_interval;
+  f.stop = stop.GetTimeStep ();
+  if (SlotOf (f.next) * m_slot >= f.stop)
+    {
+      return;
+    }
+  NS_ASSERT (SlotOf (f.next) > m_current);
+  // Set up as OnOffApplication does, but now rather than at the start time
+  f.socket = Socket::CreateSocket (source, UdpSocketFactory::GetTypeId ());
+  f.socket->Bind ();
+  f.socket->Connect (remote);
+  f.socket->SetAllowBroadcast (true);
+  f.socket->ShutdownRecv ();
+  m_flows.push_back (f);
+  Enqueue (m_flows.size () - 1);
+  ScheduleTick (SlotOf (f.next));
+}
+
+void
+CbrGenerator::Enqueue (uint32_t index)
+{
+  int64_t slot = SlotOf (m_flows[index].next);
+  if (slot < m_current + (int64_t) m_wheel.size ())
+    {
+      m_wheel[slot % m_wheel.size ()].push_back (index);
+    }
+  else
+    {
+      m_waiting.push (std::make_pair (slot, index));
+    }
+}
+
+void
+CbrGenerator::ScheduleTick (int64_t slot)
+{
+  if (m_nextTick >= 0 && m_nextTick <= slot)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  m_nextTick = slot;
+  m_event = Simulator::Schedule (TimeStep (slot * m_slot) - Simulator::Now (), &CbrGenerator::Tick, this);
+}
+
+void
+CbrGenerator::Tick (void)
+{
+  m_current = m_nextTick;
+  m_nextTick = -1;
+  m_ticks++;
+  int64_t size = m_wheel.size ();
+  while (!m_waiting.empty () && m_waiting.top ().first < m_current + size)
+    {
+      m_wheel[m_waiting.top ().first % size].push_back (m_waiting.top ().second);
+      m_waiting.pop ();
+    }
+
+  // Every flow rescheduled here lands in a later slot, never in this one
+  m_due.swap (m_wheel[m_current % size]);
+  for (std::vector<uint32_t>::const_iterator i = m_due.begin (); i != m_due.end (); ++i)
+    {
+      Flow &f = m_flows[*i];
+      // A new packet, not a copy: copies share the uid that the counters
+      // and samplers follow. The zero payload is virtual, never allocated
+      Ptr<Packet> packet = Create<Packet> (m_packetSize);
+      if (m_collector)
+        {
+          m_collector->NotifySend (f.id, packet);
+        }
+      f.socket->Send (packet);
+      m_sent++;
+      f.next += m_interval;
+      if (SlotOf (f.next) * m_slot < f.stop)
+        {
+          Enqueue (*i);
+        }
+      else
+        {
+          f.socket->Close ();
+          f.socket = 0;
+        }
+    }
+  m_due.clear ();
+
+  // The next busy slot of the wheel, else the first waiting flow
+  for (int64_t slot = m_current + 1; slot < m_current + size; slot++)
+    {
+      if (!m_wheel[slot % size].empty ())
+        {
+          ScheduleTick (slot);
+          return;
+        }
+    }
+  if (!m_waiting.empty ())
+    {
+      ScheduleTick (m_waiting.top ().first);
+    }
+}
+
+uint64_t
+CbrGenerator::GetSent (void) const
+{
+  return m_sent;
+}
+
+uint64_t
+CbrGenerator::GetTicks (void) const
+{
+  return m_ticks;
+}
+
+} // namespace ns3
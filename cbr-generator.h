@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_CBR_GENERATOR_H
+#define VANETRC_CBR_GENERATOR_H
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "flow-stats-collector.h"
+
+namespace ns3 {
+
+/**
+ * Constant bitrate UDP flows driven by one shared timer wheel instead of
+ * one OnOffApplication, and one send event per packet, per flow.
+ *
+ * Time is cut into slots. A flow sends packet k at the first slot boundary
+ * at or after start + k * interval (interval = packet size / rate, so
+ * k = 1 is the first packet, as with an always-on OnOffApplication), as
+ * long as that boundary is before stop. All the sends due in a slot are
+ * made by one event; slots without a send get no event, and flows that
+ * have not started yet wait in a heap outside the wheel. Each flow's
+ * schedule is kept exact, so the slot only adds jitter below one slot, not
+ * drift.
+ */
+class CbrGenerator : public SimpleRefCount<CbrGenerator>
+{
+public:
+  /// \param slot wheel granularity, at most the packet interval
+  CbrGenerator (uint32_t packetSize, DataRate rate, Time slot);
+
+  /// Stamp and count every send with collector (FlowStatsCollector::NotifySend)
+  void SetCollector (Ptr<FlowStatsCollector> collector);
+
+  /**
+   * Add a flow from a UDP socket on source to remote, over the absolute
+   * times [start, stop).
+   */
+  void AddFlow (uint32_t flow, Ptr<Node> source, const Address &remote, Time start, Time stop);
+
+  /// Packets sent and send events run so far
+  uint64_t GetSent (void) const;
+  uint64_t GetTicks (void) const;
+
+private:
+  struct Flow
+  {
+    uint32_t id;
+    Ptr<Socket> socket;
+    int64_t next;         //!< Nominal time of the next packet, time steps
+    int64_t stop;
+  };
+
+  /// Slot of the first boundary at or after a time
+  int64_t SlotOf (int64_t time) const;
+  /// Put a flow in the wheel, or in the waiting heap if beyond it
+  void Enqueue (uint32_t index);
+  /// Make sure a tick is scheduled no later than slot
+  void ScheduleTick (int64_t slot);
+  void Tick (void);
+
+  int64_t m_interval;
+  int64_t m_slot;
+  uint32_t m_packetSize;
+  Ptr<FlowStatsCollector> m_collector;
+  std::vector<Flow> m_flows;
+  /// Flow indices by slot modulo the wheel size
+  std::vector<std::vector<uint32_t> > m_wheel;
+  std::vector<uint32_t> m_due;
+  /// (slot, flow index) of the flows beyond the wheel, earliest first
+  std::priority_queue<std::pair<int64_t, uint32_t>, std::vector<std::pair<int64_t, uint32_t> >,
+                      std::greater<std::pair<int64_t, uint32_t> > > m_waiting;
+  int64_t m_current;    //!< Slot of the running or last tick
+  int64_t m_nextTick;   //!< Slot of the scheduled tick, -1 for none
+  EventId m_event;
+  uint64_t m_sent;
+  uint64_t m_ticks;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_CBR_GENERATOR_H */
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "condition-rreq-queue-disc.h"
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/queue.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ConditionRreqQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (ConditionRreqQueueDisc);
+
+constexpr const char* ConditionRreqQueueDisc::SUPPRESSED_DROP;
+constexpr const char* ConditionRreqQueueDisc::LIMIT_EXCEEDED_DROP;
+
+TypeId
+ConditionRreqQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ConditionRreqQueueDisc")
+    .SetParent<QueueDisc> ()
+    .AddConstructor<ConditionRreqQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("ConditionThreshold",
+                   "Condition from which a node forwards every RREQ",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&ConditionRreqQueueDisc::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ForwardProbability",
+                   "Probability that a condition 0 node forwards a RREQ",
+                   DoubleValue (0.65),
+                   MakeDoubleAccessor (&ConditionRreqQueueDisc::m_forwardProbability),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("ProtectedHops",
+                   "RREQs with at most this hop count are always forwarded; "
+                   "1 protects the rebroadcasts of the origin's neighbours",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&ConditionRreqQueueDisc::m_protectedHops),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+ConditionRreqQueueDisc::ConditionRreqQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE),
+    m_threshold (5),
+    m_forwardProbability (0.65),
+    m_protectedHops (1),
+    m_suppressedPackets (0),
+    m_suppressedBytes (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+ConditionRreqQueueDisc::~ConditionRreqQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ConditionRreqQueueDisc::DoDispose (void)
+{
+  m_node = 0;
+  m_states = 0;
+  m_random = 0;
+  QueueDisc::DoDispose ();
+}
+
+void
+ConditionRreqQueueDisc::SetNode (Ptr<Node> node, Ptr<const VehicleStateTable> states)
+{
+  m_node = node;
+  m_states = states;
+}
+
+uint64_t
+ConditionRreqQueueDisc::GetSuppressedPackets (void) const
+{
+  return m_suppressedPackets;
+}
+
+uint64_t
+ConditionRreqQueueDisc::GetSuppressedBytes (void) const
+{
+  return m_suppressedBytes;
+}
+
+int64_t
+ConditionRreqQueueDisc::AssignStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  return 1;
+}
+
+bool
+ConditionRreqQueueDisc::IsRebroadcast (Ptr<QueueDiscItem> item, uint32_t &hops) const
+{
+  Ptr<Ipv4QueueDiscItem> ipItem = DynamicCast<Ipv4QueueDiscItem> (item);
+  if (ipItem == 0 || ipItem->GetHeader ().GetProtocol () != UdpL4Protocol::PROT_NUMBER)
+    {
+      return false;
+    }
+  Ptr<Packet> packet = ipItem->GetPacket ()->Copy ();
+  UdpHeader udp;
+  packet->RemoveHeader (udp);
+  if (udp.GetDestinationPort () != aodv::RoutingProtocol::AODV_PORT)
+    {
+      return false;
+    }
+  aodv::TypeHeader type;
+  packet->RemoveHeader (type);
+  if (!type.IsValid () || type.Get () != aodv::AODVTYPE_RREQ)
+    {
+      return false;
+    }
+  aodv::RreqHeader rreq;
+  packet->PeekHeader (rreq);
+  hops = rreq.GetHopCount ();
+  return m_node->GetObject<Ipv4> ()->GetInterfaceForAddress (rreq.GetOrigin ()) < 0;
+}
+
+bool
+ConditionRreqQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t hops;
+  if (m_node && IsRebroadcast (item, hops) && hops > m_protectedHops)
+    {
+      double p = m_forwardProbability
+        + (1 - m_forwardProbability) * std::min (m_states->GetCondition (m_node->GetId ()), m_threshold) / double (m_threshold);
+      if (m_random->GetValue () >= p)
+        {
+          NS_LOG_LOGIC ("Node " << m_node->GetId () << " suppresses a RREQ rebroadcast of " << hops << " hops");
+          m_suppressedPackets++;
+          m_suppressedBytes += item->GetSize ();
+          DropBeforeEnqueue (item, SUPPRESSED_DROP);
+          return false;
+        }
+    }
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      return false;
+    }
+  return GetInternalQueue (0)->Enqueue (item);
+}
+
+Ptr<QueueDiscItem>
+ConditionRreqQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetInternalQueue (0)->Dequeue ();
+}
+
+bool
+ConditionRreqQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0 || GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("ConditionRreqQueueDisc takes no classes or packet filters");
+      return false;
+    }
+  if (GetNInternalQueues () == 0)
+    {
+      AddInternalQueue (CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+                          ("MaxSize", QueueSizeValue (GetMaxSize ())));
+    }
+  if (GetNInternalQueues () != 1)
+    {
+      NS_LOG_ERROR ("ConditionRreqQueueDisc needs 1 internal queue");
+      return false;
+    }
+  return true;
+}
+
+void
+ConditionRreqQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+} // namespace ns3
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_CONDITION_RREQ_QUEUE_DISC_H
+#define VANETRC_CONDITION_RREQ_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node.h"
+#include "vehicle-state-table.h"
+
+namespace ns3 {
+
+/**
+ * FIFO root queue disc that gossips AODV RREQ rebroadcasts by node condition.
+ *
+ * aodv::RoutingProtocol keeps its RREQ handling private, so the decision
+ * is taken on the way to the device instead: a RREQ leaving this node that
+ * it did not originate is a rebroadcast, and it is dropped with probability
+ * 1 - p. p is ForwardProbability for a condition 0 node and rises linearly
+ * to 1 at ConditionThreshold. AODV counts the hop before rebroadcasting,
+ * so the origin's neighbours send hop count 1; RREQs with at most
+ * ProtectedHops (at least 1) are always forwarded so discovery does not
+ * die out at the source. Floods thus travel over good-condition nodes,
+ * which is where the first RREQ copy (and with DestinationOnly, the
+ * selected route) comes from. Every other packet is plain FIFO.
+ */
+class ConditionRreqQueueDisc : public QueueDisc
+{
+public:
+  static TypeId GetTypeId (void);
+  ConditionRreqQueueDisc ();
+  virtual ~ConditionRreqQueueDisc ();
+
+  /// The node whose addresses are used, and the table holding its condition
+  void SetNode (Ptr<Node> node, Ptr<const VehicleStateTable> states);
+
+  /// RREQ rebroadcasts dropped so far, and their IP bytes
+  uint64_t GetSuppressedPackets (void) const;
+  uint64_t GetSuppressedBytes (void) const;
+
+  int64_t AssignStreams (int64_t stream);
+
+  static constexpr const char* SUPPRESSED_DROP = "Suppressed RREQ rebroadcast";
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+  virtual void DoDispose (void);
+
+  /**
+   * True if item is a RREQ this node forwards rather than originates.
+   *
+   * \param hops set to the RREQ's hop count, which includes this node
+   */
+  bool IsRebroadcast (Ptr<QueueDiscItem> item, uint32_t &hops) const;
+
+  Ptr<Node> m_node;
+  Ptr<const VehicleStateTable> m_states;
+  Ptr<UniformRandomVariable> m_random;
+  uint32_t m_threshold;
+  double m_forwardProbability;
+  uint32_t m_protectedHops;
+  uint64_t m_suppressedPackets;
+  uint64_t m_suppressedBytes;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_CONDITION_RREQ_QUEUE_DISC_H */
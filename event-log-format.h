@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_EVENT_LOG_FORMAT_H
+#define VANETRC_EVENT_LOG_FORMAT_H
+
+#include <stdint.h>
+
+/*
+ * Scenario events of one replication, written by EventLog and formatted by
+ * tools/vanetrc-events. Host byte order.
+ *
+ *   EventLogHeader
+ *   EventRecord records[header.records]
+ *
+ * Records are in time order, events of the same time in the order they
+ * were logged. Each type uses the fields listed with it; the others are
+ * zero.
+ */
+
+#define EVENT_LOG_MAGIC "VRCEVT1"
+#define EVENT_LOG_VERSION 1
+
+enum EventType
+{
+  EVENT_WARM_START = 0,    //!< Replication forked from a warm start
+  EVENT_FLOW_SETUP = 1,    //!< a flow, b source, c sink, value start s, stop s
+  EVENT_APP_START = 2,     //!< a flow, b source; at the first packet sent
+  EVENT_APP_STOP = 3,      //!< a flow, b source; at the last packet sent
+  EVENT_QUIESCENT = 4,     //!< No data packet left in flight
+  EVENT_SINK = 5,          //!< a node, value rx bytes
+  EVENT_FLOW_RESULT = 6,   //!< a flow, b source, c sink, value PDF %, delay s, rx kbps, tx kbps
+  EVENT_ROUTING_LOAD = 7,  //!< a RREQs suppressed, value RL tx, rx packets, tx, rx bytes
+  EVENT_TOTAL = 8,         //!< a connections, value PDF %, rx kbps, delay s
+  EVENT_ROUTE_FOUND = 9,   //!< a flow, b source, c sink, value s from first send; at the first delivery
+  EVENT_ROUTE_DUMP = 10,   //!< a dump (1 to 3) of every table to xml/routing_table<a>
+  EVENT_ROUTE_DIFF = 11,   //!< a routes added, b changed, c removed, value full snapshot (1) or diff (0)
+  EVENT_TYPES = 12
+};
+
+struct EventLogHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t records;
+  char routing[16];        //!< NUL terminated
+  uint32_t size;           //!< Nodes
+  uint32_t connections;
+  uint32_t seed;
+  uint32_t packetSize;     //!< Bytes
+};
+
+struct EventRecord
+{
+  double time;             //!< s
+  uint32_t type;           //!< EventType
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  double value[4];
+};
+
+static_assert (sizeof (EventLogHeader) == 48, "EventLogHeader layout");
+static_assert (sizeof (EventRecord) == 56, "EventRecord layout");
+
+#endif /* VANETRC_EVENT_LOG_FORMAT_H */
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "event-log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventLog");
+
+EventLog::EventLog ()
+{
+  // A replication logs a handful of records per flow
+  m_records.reserve (256);
+}
+
+void
+EventLog::Add (EventType type, uint32_t a, uint32_t b, uint32_t c,
+               double v0, double v1, double v2, double v3)
+{
+  AddAt (Simulator::Now (), type, a, b, c, v0, v1, v2, v3);
+}
+
+void
+EventLog::AddAt (Time time, EventType type, uint32_t a, uint32_t b, uint32_t c,
+                 double v0, double v1, double v2, double v3)
+{
+  EventRecord r;
+  r.time = time.GetSeconds ();
+  r.type = type;
+  r.a = a;
+  r.b = b;
+  r.c = c;
+  r.value[0] = v0;
+  r.value[1] = v1;
+  r.value[2] = v2;
+  r.value[3] = v3;
+  m_records.push_back (r);
+}
+
+bool
+EventLog::Write (const std::string &path, const std::string &routing, uint32_t size,
+                 uint32_t connections, uint32_t seed, uint32_t packetSize)
+{
+  // Some events are only known after the run, e.g. when a flow's first
+  // packet left; events at the same time keep the order they were logged
+  std::stable_sort (m_records.begin (), m_records.end (),
+                    [] (const EventRecord &a, const EventRecord &b) { return a.time < b.time; });
+  std::FILE *f = std::fopen (path.c_str (), "wb");
+  if (f == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  EventLogHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, EVENT_LOG_MAGIC, sizeof (EVENT_LOG_MAGIC));
+  header.version = EVENT_LOG_VERSION;
+  header.records = m_records.size ();
+  std::strncpy (header.routing, routing.c_str (), sizeof (header.routing) - 1);
+  header.size = size;
+  header.connections = connections;
+  header.seed = seed;
+  header.packetSize = packetSize;
+  bool ok = std::fwrite (&header, sizeof (header), 1, f) == 1
+    && std::fwrite (m_records.data (), sizeof (EventRecord), m_records.size (), f) == m_records.size ();
+  return std::fclose (f) == 0 && ok;
+}
+
+uint32_t
+EventLog::GetN (void) const
+{
+  return m_records.size ();
+}
+
+} // namespace ns3
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_EVENT_LOG_H
+#define VANETRC_EVENT_LOG_H
+
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "event-log-format.h"
+
+namespace ns3 {
+
+/**
+ * Scenario events of a replication as fixed-size binary records (see
+ * event-log-format.h), kept in memory and written once at the end.
+ *
+ * Logging an event copies a few numbers; nothing is formatted until
+ * tools/vanetrc-events reads the file.
+ */
+class EventLog : public SimpleRefCount<EventLog>
+{
+public:
+  EventLog ();
+
+  /// Log an event now
+  void Add (EventType type, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0,
+            double v0 = 0, double v1 = 0, double v2 = 0, double v3 = 0);
+  /// Log an event that happened at time
+  void AddAt (Time time, EventType type, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0,
+              double v0 = 0, double v1 = 0, double v2 = 0, double v3 = 0);
+
+  /// Sort the records by time and write the header and every record to path
+  bool Write (const std::string &path, const std::string &routing, uint32_t size,
+              uint32_t connections, uint32_t seed, uint32_t packetSize);
+
+  uint32_t GetN (void) const;
+
+private:
+  std::vector<EventRecord> m_records;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_EVENT_LOG_H */
@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "flow-stats-collector.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowStatsCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowStampTag);
+
+TypeId
+FlowStampTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowStampTag")
+    .SetParent<Tag> ()
+    .AddConstructor<FlowStampTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+FlowStampTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+FlowStampTag::FlowStampTag ()
+  : m_flow (0),
+    m_txTime (0)
+{
+}
+
+FlowStampTag::FlowStampTag (uint32_t flow, int64_t txTime)
+  : m_flow (flow),
+    m_txTime (txTime)
+{
+}
+
+uint32_t
+FlowStampTag::GetFlow (void) const
+{
+  return m_flow;
+}
+
+int64_t
+FlowStampTag::GetTxTime (void) const
+{
+  return m_txTime;
+}
+
+uint32_t
+FlowStampTag::GetSerializedSize (void) const
+{
+  return 12;
+}
+
+void
+FlowStampTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_flow);
+  buf.WriteU64 (m_txTime);
+}
+
+void
+FlowStampTag::Deserialize (TagBuffer buf)
+{
+  m_flow = buf.ReadU32 ();
+  m_txTime = buf.ReadU64 ();
+}
+
+void
+FlowStampTag::Print (std::ostream &os) const
+{
+  os << "flow=" << m_flow << " txTime=" << m_txTime;
+}
+
+FlowStatsCollector::FlowStatsCollector (const FlowTable &flows)
+{
+  FlowCounters empty;
+  std::memset (&empty, 0, sizeof (empty));
+  empty.firstTx = empty.lastTx = empty.firstRx = empty.lastRx = -1;
+  m_flows.reserve (flows.GetN ());
+  for (uint32_t i = 0; i < flows.GetN (); i++)
+    {
+      m_flows.push_back (flows.Get (i));
+    }
+  m_counters.assign (flows.GetN (), empty);
+}
+
+void
+FlowStatsCollector::ConnectSource (uint32_t flow, Ptr<Application> app)
+{
+  NS_ASSERT (flow < m_counters.size ());
+  app->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&FlowStatsCollector::NotifyTx, this, flow));
+}
+
+void
+FlowStatsCollector::NotifySend (uint32_t flow, Ptr<const Packet> packet)
+{
+  NS_ASSERT (flow < m_counters.size ());
+  NotifyTx (this, flow, packet);
+}
+
+void
+FlowStatsCollector::ConnectSink (Ptr<Application> app)
+{
+  app->TraceConnectWithoutContext ("Rx", MakeCallback (&FlowStatsCollector::NotifyRx, this));
+}
+
+void
+FlowStatsCollector::NotifyTx (FlowStatsCollector *collector, uint32_t flow, Ptr<const Packet> packet)
+{
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  packet->AddByteTag (FlowStampTag (flow, now));
+  FlowCounters &c = collector->m_counters[flow];
+  c.txPackets++;
+  c.txBytes += packet->GetSize ();
+  if (c.firstTx < 0)
+    {
+      c.firstTx = now;
+    }
+  c.lastTx = now;
+}
+
+void
+FlowStatsCollector::NotifyRx (Ptr<const Packet> packet, const Address &from)
+{
+  FlowStampTag stamp;
+  if (!packet->FindFirstMatchingByteTag (stamp) || stamp.GetFlow () >= m_counters.size ())
+    {
+      return;
+    }
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  FlowCounters &c = m_counters[stamp.GetFlow ()];
+  c.rxPackets++;
+  c.rxBytes += packet->GetSize ();
+  c.delaySum += now - stamp.GetTxTime ();
+  if (c.firstRx < 0)
+    {
+      c.firstRx = now;
+    }
+  c.lastRx = now;
+}
+
+uint32_t
+FlowStatsCollector::GetN (void) const
+{
+  return m_counters.size ();
+}
+
+const FlowSpec &
+FlowStatsCollector::GetFlow (uint32_t flow) const
+{
+  return m_flows[flow];
+}
+
+const FlowCounters &
+FlowStatsCollector::Get (uint32_t flow) const
+{
+  return m_counters[flow];
+}
+
+bool
+FlowStatsCollector::WriteBinary (const std::string &path) const
+{
+  std::FILE *f = std::fopen (path.c_str (), "wb");
+  if (f == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  FlowStatsHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, FLOW_STATS_MAGIC, sizeof (FLOW_STATS_MAGIC));
+  header.version = FLOW_STATS_VERSION;
+  header.flows = m_counters.size ();
+  header.resolution = Seconds (1).GetTimeStep ();
+  bool ok = std::fwrite (&header, sizeof (header), 1, f) == 1
+    && std::fwrite (m_flows.data (), sizeof (FlowSpec), m_flows.size (), f) == m_flows.size ()
+    && std::fwrite (m_counters.data (), sizeof (FlowCounters), m_counters.size (), f) == m_counters.size ();
+  return std::fclose (f) == 0 && ok;
+}
+
+bool
+FlowStatsCollector::WriteXml (const std::string &path) const
+{
+  std::ofstream os (path.c_str ());
+  if (!os)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  os << "<?xml version=\"1.0\" ?>\n<FlowStats>\n";
+  for (uint32_t i = 0; i < m_counters.size (); i++)
+    {
+      const FlowSpec &f = m_flows[i];
+      const FlowCounters &c = m_counters[i];
+      os << "  <Flow flowId=\"" << i << "\""
+         << " source=\"" << f.source << "\" sink=\"" << f.sink << "\""
+         << " txPackets=\"" << c.txPackets << "\" txBytes=\"" << c.txBytes << "\""
+         << " rxPackets=\"" << c.rxPackets << "\" rxBytes=\"" << c.rxBytes << "\""
+         << " delaySum=\"" << TimeStep (c.delaySum).GetSeconds () << "\""
+         << " timeFirstTxPacket=\"" << TimeStep (c.firstTx).GetSeconds () << "\""
+         << " timeLastTxPacket=\"" << TimeStep (c.lastTx).GetSeconds () << "\""
+         << " timeFirstRxPacket=\"" << TimeStep (c.firstRx).GetSeconds () << "\""
+         << " timeLastRxPacket=\"" << TimeStep (c.lastRx).GetSeconds () << "\" />\n";
+    }
+  os << "</FlowStats>\n";
+  return bool (os);
+}
+
+} // namespace ns3
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_FLOW_STATS_COLLECTOR_H
+#define VANETRC_FLOW_STATS_COLLECTOR_H
+
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "flow-table.h"
+
+/*
+ * Binary dump of a FlowStatsCollector, host byte order:
+ *
+ *   FlowStatsHeader
+ *   FlowSpec flows[header.flows]
+ *   FlowCounters counters[header.flows]
+ */
+
+#define FLOW_STATS_MAGIC "VRCFLW1"
+#define FLOW_STATS_VERSION 1
+
+namespace ns3 {
+
+struct FlowStatsHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t flows;
+  int64_t resolution;      //!< Time steps per second of the counters' times
+};
+
+/**
+ * Counters of one data flow. Times are simulator time steps, -1 until the
+ * first packet.
+ */
+struct FlowCounters
+{
+  uint64_t txPackets;
+  uint64_t txBytes;
+  uint64_t rxPackets;
+  uint64_t rxBytes;
+  int64_t delaySum;
+  int64_t firstTx;
+  int64_t lastTx;
+  int64_t firstRx;
+  int64_t lastRx;
+};
+
+/**
+ * Byte tag stamped on a data packet when its application sends it.
+ */
+class FlowStampTag : public Tag
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  FlowStampTag ();
+  FlowStampTag (uint32_t flow, int64_t txTime);
+
+  uint32_t GetFlow (void) const;
+  /// Send time, time steps
+  int64_t GetTxTime (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_flow;
+  int64_t m_txTime;
+};
+
+/**
+ * Per-flow packet, byte, delay and first/last time counters of the data
+ * flows of a FlowTable, in one array allocated up front.
+ *
+ * A source's Tx trace stamps each packet with its flow and send time and
+ * counts it; a sink's Rx trace reads the stamp back and counts the
+ * delivery and its delay. Nothing else is kept, so the summary metrics are
+ * read straight from the counters. WriteBinary () and WriteXml () export
+ * them on request.
+ *
+ * Sends are counted at the application, before Socket::Send (), not at
+ * the IP layer as FlowMonitor does. A packet the socket refuses (OLSR and
+ * DSDV with no route yet) therefore counts as sent and lost, and one DSR
+ * buffers while it discovers a route counts once when offered.
+ */
+class FlowStatsCollector : public SimpleRefCount<FlowStatsCollector>
+{
+public:
+  explicit FlowStatsCollector (const FlowTable &flows);
+
+  /// Count what the OnOffApplication app sends as flow
+  void ConnectSource (uint32_t flow, Ptr<Application> app);
+  /// Stamp and count a packet that another sender sends as flow
+  void NotifySend (uint32_t flow, Ptr<const Packet> packet);
+  /// Count the stamped packets the PacketSink app receives
+  void ConnectSink (Ptr<Application> app);
+
+  uint32_t GetN (void) const;
+  const FlowSpec &GetFlow (uint32_t flow) const;
+  const FlowCounters &Get (uint32_t flow) const;
+
+  bool WriteBinary (const std::string &path) const;
+  bool WriteXml (const std::string &path) const;
+
+private:
+  static void NotifyTx (FlowStatsCollector *collector, uint32_t flow, Ptr<const Packet> packet);
+  void NotifyRx (Ptr<const Packet> packet, const Address &from);
+
+  std::vector<FlowSpec> m_flows;
+  std::vector<FlowCounters> m_counters;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_FLOW_STATS_COLLECTOR_H */
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "flow-table.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+void
+FlowTable::Add (const FlowSpec &flow)
+{
+  m_flows.push_back (flow);
+}
+
+void
+FlowTable::Clear (void)
+{
+  m_flows.clear ();
+}
+
+void
+FlowTable::Reserve (uint32_t n)
+{
+  m_flows.reserve (n);
+}
+
+uint32_t
+FlowTable::GetN (void) const
+{
+  return m_flows.size ();
+}
+
+const FlowSpec &
+FlowTable::Get (uint32_t i) const
+{
+  return m_flows[i];
+}
+
+double
+FlowTable::GetLastStop (void) const
+{
+  double last = 0;
+  for (std::vector<FlowSpec>::const_iterator i = m_flows.begin (); i != m_flows.end (); ++i)
+    {
+      last = std::max (last, i->stop);
+    }
+  return last;
+}
+
+bool
+FlowTable::Load (const std::string &path, uint32_t nodes, std::string &error)
+{
+  std::ifstream in (path.c_str ());
+  if (!in)
+    {
+      error = "cannot open " + path;
+      return false;
+    }
+  m_flows.clear ();
+  std::string line;
+  uint32_t lineNo = 0;
+  while (std::getline (in, line))
+    {
+      lineNo++;
+      std::string::size_type first = line.find_first_not_of (" \t\r");
+      if (first == std::string::npos || line[first] == '#')
+        {
+          continue;
+        }
+      std::istringstream fields (line);
+      FlowSpec flow;
+      if (!(fields >> flow.source >> flow.sink >> flow.start >> flow.stop)
+          || flow.source >= nodes || flow.sink >= nodes
+          || flow.source == flow.sink || flow.stop <= flow.start)
+        {
+          std::ostringstream os;
+          os << path << ":" << lineNo << ": bad flow \"" << line << "\"";
+          error = os.str ();
+          return false;
+        }
+      m_flows.push_back (flow);
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_FLOW_TABLE_H
+#define VANETRC_FLOW_TABLE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * One data flow: a constant bitrate stream from source to sink node.
+ */
+struct FlowSpec
+{
+  uint32_t source;
+  uint32_t sink;
+  double start;         //!< Absolute start time, s
+  double stop;          //!< Absolute stop time, s
+};
+
+/**
+ * The data flows of a replication, generated by the scenario or read from
+ * a text file with one "source sink start stop" line per flow. Blank lines
+ * and lines starting with '#' are skipped.
+ */
+class FlowTable
+{
+public:
+  void Add (const FlowSpec &flow);
+  void Clear (void);
+  void Reserve (uint32_t n);
+
+  uint32_t GetN (void) const;
+  const FlowSpec &Get (uint32_t i) const;
+
+  /// Latest stop time of the flows, 0 for none
+  double GetLastStop (void) const;
+
+  /**
+   * Replace the table with the flows of a file.
+   *
+   * \param nodes number of nodes; flows with an endpoint beyond it, equal
+   *        endpoints or stop <= start are rejected
+   * \param error set to the reason when the file is rejected
+   * \return false if the file cannot be read or has a bad line
+   */
+  bool Load (const std::string &path, uint32_t nodes, std::string &error);
+
+private:
+  std::vector<FlowSpec> m_flows;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_FLOW_TABLE_H */
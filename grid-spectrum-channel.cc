@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "grid-spectrum-channel.h"
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/angles.h"
+#include "ns3/antenna-model.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/spectrum-propagation-loss-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("GridSpectrumChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (GridSpectrumChannel);
+
+TypeId
+GridSpectrumChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GridSpectrumChannel")
+    .SetParent<SpectrumChannel> ()
+    .AddConstructor<GridSpectrumChannel> ()
+    .AddAttribute ("MaxRange",
+                   "Farthest distance a transmission can be received at, in meters. "
+                   "Also the grid cell size.",
+                   DoubleValue (1000.0),
+                   MakeDoubleAccessor (&GridSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("MaxSpeed",
+                   "Lower bound of the fastest node's speed in m/s, for mobility "
+                   "models whose velocity changes without a CourseChange.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GridSpectrumChannel::m_maxSpeed),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+GridSpectrumChannel::GridSpectrumChannel ()
+  : m_maxRange (1000.0),
+    m_maxSpeed (0.0),
+    m_speed (0.0),
+    m_binned (false),
+    m_culled (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+GridSpectrumChannel::~GridSpectrumChannel ()
+{
+}
+
+void
+GridSpectrumChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_phyList.clear ();
+  m_mobility.clear ();
+  m_cell.clear ();
+  m_index.clear ();
+  m_grid.clear ();
+  SpectrumChannel::DoDispose ();
+}
+
+void
+GridSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  // The phy usually gets its mobility after joining the channel, so
+  // binning waits for the first transmission
+  m_phyList.push_back (phy);
+  m_mobility.push_back (0);
+  m_cell.push_back (0);
+  m_binned = false;
+}
+
+std::size_t
+GridSpectrumChannel::GetNDevices (void) const
+{
+  return m_phyList.size ();
+}
+
+Ptr<NetDevice>
+GridSpectrumChannel::GetDevice (std::size_t i) const
+{
+  return m_phyList.at (i)->GetDevice ();
+}
+
+uint64_t
+GridSpectrumChannel::GetCulledReceptions (void) const
+{
+  return m_culled;
+}
+
+int64_t
+GridSpectrumChannel::Key (int32_t ix, int32_t iy)
+{
+  return static_cast<int64_t> ((static_cast<uint64_t> (static_cast<uint32_t> (ix)) << 32)
+                               | static_cast<uint32_t> (iy));
+}
+
+int64_t
+GridSpectrumChannel::CellOf (const Vector &position) const
+{
+  return Key (static_cast<int32_t> (std::floor (position.x / m_maxRange)),
+              static_cast<int32_t> (std::floor (position.y / m_maxRange)));
+}
+
+void
+GridSpectrumChannel::Bin (uint32_t i)
+{
+  int64_t cell = CellOf (m_mobility[i]->GetPosition ());
+  if (cell == m_cell[i])
+    {
+      return;
+    }
+  std::vector<uint32_t> &old = m_grid[m_cell[i]];
+  old.erase (std::find (old.begin (), old.end (), i));
+  m_grid[cell].push_back (i);
+  m_cell[i] = cell;
+}
+
+void
+GridSpectrumChannel::RebinAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_binned)
+    {
+      m_grid.clear ();
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          if (m_mobility[i] == 0)
+            {
+              m_mobility[i] = m_phyList[i]->GetMobility ();
+              NS_ABORT_MSG_IF (m_mobility[i] == 0, "GridSpectrumChannel needs a mobility model on every phy");
+              m_index[PeekPointer (m_mobility[i])] = i;
+              m_mobility[i]->TraceConnectWithoutContext ("CourseChange",
+                MakeCallback (&GridSpectrumChannel::CourseChanged, this));
+            }
+          m_cell[i] = CellOf (m_mobility[i]->GetPosition ());
+          m_grid[m_cell[i]].push_back (i);
+        }
+      m_binned = true;
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          Bin (i);
+        }
+    }
+  m_speed = 0;
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      m_speed = std::max (m_speed, m_mobility[i]->GetVelocity ().GetLength ());
+    }
+  m_lastRebin = Simulator::Now ();
+}
+
+void
+GridSpectrumChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  if (!m_binned)
+    {
+      return;
+    }
+  Bin (m_index[PeekPointer (mobility)]);
+  m_speed = std::max (m_speed, mobility->GetVelocity ().GetLength ());
+}
+
+double
+GridSpectrumChannel::RangeForLoss (Ptr<PropagationLossModel> loss, double maxLossDb)
+{
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  double low = 0;
+  double high = 1;
+  // Grow the bracket, then bisect down to a centimeter
+  b->SetPosition (Vector (high, 0, 0));
+  while (-loss->CalcRxPower (0, a, b) <= maxLossDb && high < 1e7)
+    {
+      low = high;
+      high *= 2;
+      b->SetPosition (Vector (high, 0, 0));
+    }
+  while (high - low > 0.01)
+    {
+      double mid = (low + high) / 2;
+      b->SetPosition (Vector (mid, 0, 0));
+      if (-loss->CalcRxPower (0, a, b) <= maxLossDb)
+        {
+          low = mid;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+  return high;
+}
+
+void
+GridSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
+{
+  NS_LOG_FUNCTION (this << txParams->psd << txParams->duration << txParams->txPhy);
+  NS_ASSERT_MSG (txParams->psd, "NULL txPsd");
+  NS_ASSERT_MSG (txParams->txPhy, "NULL txPhy");
+
+  if (!m_binned)
+    {
+      RebinAll ();
+    }
+  // How far a receiver may be from the cell it was binned in
+  double drift = std::max (m_speed, m_maxSpeed) * (Simulator::Now () - m_lastRebin).GetSeconds ();
+  if (drift > m_maxRange / 2)
+    {
+      RebinAll ();
+      drift = 0;
+    }
+
+  Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  Vector senderPosition = senderMobility->GetPosition ();
+  double radius = m_maxRange + drift;
+  int32_t x0 = static_cast<int32_t> (std::floor ((senderPosition.x - radius) / m_maxRange));
+  int32_t x1 = static_cast<int32_t> (std::floor ((senderPosition.x + radius) / m_maxRange));
+  int32_t y0 = static_cast<int32_t> (std::floor ((senderPosition.y - radius) / m_maxRange));
+  int32_t y1 = static_cast<int32_t> (std::floor ((senderPosition.y + radius) / m_maxRange));
+
+  uint64_t candidates = 0;
+  for (int32_t ix = x0; ix <= x1; ix++)
+    {
+      for (int32_t iy = y0; iy <= y1; iy++)
+        {
+          std::unordered_map<int64_t, std::vector<uint32_t> >::const_iterator cell = m_grid.find (Key (ix, iy));
+          if (cell == m_grid.end ())
+            {
+              continue;
+            }
+          for (std::vector<uint32_t>::const_iterator it = cell->second.begin (); it != cell->second.end (); ++it)
+            {
+              Ptr<SpectrumPhy> rxPhy = m_phyList[*it];
+              if (rxPhy == txParams->txPhy)
+                {
+                  continue;
+                }
+              candidates++;
+              Ptr<MobilityModel> receiverMobility = m_mobility[*it];
+              if (CalculateDistance (senderPosition, receiverMobility->GetPosition ()) > m_maxRange)
+                {
+                  continue;
+                }
+
+              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+              double pathLossDb = 0;
+              if (rxParams->txAntenna != 0)
+                {
+                  Angles txAngles (receiverMobility->GetPosition (), senderPosition);
+                  pathLossDb -= rxParams->txAntenna->GetGainDb (txAngles);
+                }
+              Ptr<AntennaModel> rxAntenna = rxPhy->GetRxAntenna ();
+              if (rxAntenna != 0)
+                {
+                  Angles rxAngles (senderPosition, receiverMobility->GetPosition ());
+                  pathLossDb -= rxAntenna->GetGainDb (rxAngles);
+                }
+              if (m_propagationLoss)
+                {
+                  pathLossDb -= m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
+                }
+              if (pathLossDb > m_maxLossDb)
+                {
+                  continue;
+                }
+              *(rxParams->psd) *= std::pow (10.0, (-pathLossDb) / 10.0);
+              if (m_spectrumPropagationLoss)
+                {
+                  rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, senderMobility, receiverMobility);
+                }
+              Time delay = MicroSeconds (0);
+              if (m_propagationDelay)
+                {
+                  delay = m_propagationDelay->GetDelay (senderMobility, receiverMobility);
+                }
+
+              Ptr<NetDevice> netDev = rxPhy->GetDevice ();
+              if (netDev)
+                {
+                  Simulator::ScheduleWithContext (netDev->GetNode ()->GetId (), delay,
+                                                  &GridSpectrumChannel::StartRx, this, rxParams, rxPhy);
+                }
+              else
+                {
+                  Simulator::Schedule (delay, &GridSpectrumChannel::StartRx, this, rxParams, rxPhy);
+                }
+            }
+        }
+    }
+  m_culled += m_phyList.size () - 1 - candidates;
+}
+
+void
+GridSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << params);
+  receiver->StartRx (params);
+}
+
+} // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_GRID_SPECTRUM_CHANNEL_H
+#define VANETRC_GRID_SPECTRUM_CHANNEL_H
+
+#include <unordered_map>
+#include <vector>
+#include "ns3/spectrum-channel.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class SpectrumPhy;
+class SpectrumSignalParameters;
+class PropagationLossModel;
+
+/**
+ * Single spectrum model channel that only delivers a transmission to the
+ * PHYs that can be within MaxRange of the sender.
+ *
+ * The PHYs are binned into a uniform grid of MaxRange sized cells, so a
+ * transmission visits the 3x3 cells around the sender instead of every
+ * PHY. Bins are updated on each mobility model's CourseChange. Between
+ * course changes a node can drift out of its cell, so the search radius
+ * grows by the distance the fastest node may have covered since the last
+ * full rebinning, and everything is rebinned once that margin reaches half
+ * a cell. Static topologies are binned once.
+ *
+ * Receivers inside the search radius go through the same loss, MaxLossDb
+ * and delay handling as SingleModelSpectrumChannel; all the PHYs must use
+ * the same SpectrumModel.
+ */
+class GridSpectrumChannel : public SpectrumChannel
+{
+public:
+  GridSpectrumChannel ();
+  virtual ~GridSpectrumChannel ();
+
+  static TypeId GetTypeId (void);
+
+  // inherited from SpectrumChannel
+  virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+
+  // inherited from Channel
+  virtual std::size_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
+
+  /**
+   * Largest distance at which loss stays within maxLossDb, found by
+   * bisection; the model must be deterministic and monotone in distance.
+   *
+   * \param loss the propagation loss model of the channel
+   * \param maxLossDb link budget, tx power + gains - rx sensitivity
+   * \return the range in meters
+   */
+  static double RangeForLoss (Ptr<PropagationLossModel> loss, double maxLossDb);
+
+  /**
+   * \return number of receptions skipped because the receiver was out of
+   *         the search radius
+   */
+  uint64_t GetCulledReceptions (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /// Cell key of grid coordinates
+  static int64_t Key (int32_t ix, int32_t iy);
+  /// Cell key of a position
+  int64_t CellOf (const Vector &position) const;
+  /// Put phy i into the cell of its current position
+  void Bin (uint32_t i);
+  /// Rebin every phy and reset the drift margin
+  void RebinAll (void);
+  /// CourseChange sink of the phys' mobility models
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  /// Deliver params to receiver
+  void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  typedef std::vector<Ptr<SpectrumPhy> > PhyList;
+  PhyList m_phyList;
+
+  std::vector<Ptr<MobilityModel> > m_mobility; //!< per phy, resolved lazily
+  std::vector<int64_t> m_cell;                 //!< per phy, current cell key
+  std::unordered_map<const MobilityModel *, uint32_t> m_index; //!< mobility -> phy
+  std::unordered_map<int64_t, std::vector<uint32_t> > m_grid;
+
+  double m_maxRange;     //!< cell size and base search radius, m
+  double m_maxSpeed;     //!< lower bound of the fastest node's speed, m/s
+  double m_speed;        //!< fastest speed seen since the last rebinning
+  Time m_lastRebin;
+  bool m_binned;
+  uint64_t m_culled;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_GRID_SPECTRUM_CHANNEL_H */
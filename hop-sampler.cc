@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "hop-sampler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "flow-stats-collector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HopSampler");
+
+HopSampler::HopSampler (const FlowTable &flows, uint32_t sampleEvery)
+  : m_sampleEvery (sampleEvery)
+{
+  NS_ASSERT (sampleEvery > 0);
+  FlowHops zero = { 0, 0, 0, 0, 0 };
+  m_flows.assign (flows.GetN (), zero);
+  for (uint32_t i = 0; i < flows.GetN (); i++)
+    {
+      m_specs.push_back (flows.Get (i));
+    }
+}
+
+void
+HopSampler::Install (const NodeContainer &nodes)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<Ipv4L3Protocol> ipv4 = (*i)->GetObject<Ipv4L3Protocol> ();
+      NS_ABORT_MSG_IF (ipv4 == 0, "Node " << (*i)->GetId () << " has no internet stack");
+      uint32_t id = (*i)->GetId ();
+      if (id >= m_relayed.size ())
+        {
+          m_relayed.resize (id + 1, 0);
+        }
+      ipv4->TraceConnectWithoutContext ("SendOutgoing", MakeBoundCallback (&HopSampler::SendOutgoing, this, id));
+      ipv4->TraceConnectWithoutContext ("UnicastForward", MakeBoundCallback (&HopSampler::UnicastForward, this, id));
+      ipv4->TraceConnectWithoutContext ("LocalDeliver", MakeBoundCallback (&HopSampler::LocalDeliver, this, id));
+    }
+  m_event.Cancel ();
+  m_event = Simulator::Schedule (Seconds (1), &HopSampler::Expire, this);
+}
+
+void
+HopSampler::Stop (void)
+{
+  m_event.Cancel ();
+}
+
+void
+HopSampler::Expire (void)
+{
+  // AODV and DSR hold a packet for at most 30 s during a route search
+  int64_t oldest = (Simulator::Now () - Seconds (30)).GetTimeStep ();
+  for (std::unordered_map<uint64_t, Path>::iterator i = m_paths.begin (); i != m_paths.end (); )
+    {
+      if (i->second.seen < oldest)
+        {
+          i = m_paths.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  m_event = Simulator::Schedule (Seconds (1), &HopSampler::Expire, this);
+}
+
+void
+HopSampler::SendOutgoing (HopSampler *sampler, uint32_t node, const Ipv4Header &header,
+                          Ptr<const Packet> packet, uint32_t interface)
+{
+  FlowStampTag stamp;
+  if (packet->GetUid () % sampler->m_sampleEvery != 0
+      || !packet->FindFirstMatchingByteTag (stamp)
+      || stamp.GetFlow () >= sampler->m_flows.size ())
+    {
+      return;
+    }
+  if (node == sampler->m_specs[stamp.GetFlow ()].source)
+    {
+      Path path = { stamp.GetFlow (), 1, Simulator::Now ().GetTimeStep () };
+      sampler->m_paths[packet->GetUid ()] = path;
+      sampler->m_flows[stamp.GetFlow ()].sent++;
+      return;
+    }
+  // DSR sends the data again from every relay it passed up to
+  std::unordered_map<uint64_t, Path>::iterator i = sampler->m_paths.find (packet->GetUid ());
+  if (i != sampler->m_paths.end ())
+    {
+      i->second.hops++;
+      i->second.seen = Simulator::Now ().GetTimeStep ();
+      sampler->m_relayed[node]++;
+    }
+}
+
+void
+HopSampler::UnicastForward (HopSampler *sampler, uint32_t node, const Ipv4Header &header,
+                            Ptr<const Packet> packet, uint32_t interface)
+{
+  if (packet->GetUid () % sampler->m_sampleEvery != 0)
+    {
+      return;
+    }
+  std::unordered_map<uint64_t, Path>::iterator i = sampler->m_paths.find (packet->GetUid ());
+  // AODV sends the packets it held during a route search through its
+  // source's forwarding path; that is not a hop
+  if (i != sampler->m_paths.end () && node != sampler->m_specs[i->second.flow].source)
+    {
+      i->second.hops++;
+      i->second.seen = Simulator::Now ().GetTimeStep ();
+      sampler->m_relayed[node]++;
+    }
+}
+
+void
+HopSampler::LocalDeliver (HopSampler *sampler, uint32_t node, const Ipv4Header &header,
+                          Ptr<const Packet> packet, uint32_t interface)
+{
+  if (packet->GetUid () % sampler->m_sampleEvery != 0)
+    {
+      return;
+    }
+  std::unordered_map<uint64_t, Path>::iterator i = sampler->m_paths.find (packet->GetUid ());
+  FlowStampTag stamp;
+  if (i == sampler->m_paths.end () || !packet->FindFirstMatchingByteTag (stamp))
+    {
+      return;
+    }
+  if (node != sampler->m_specs[i->second.flow].sink)
+    {
+      // A DSR relay; the hop counts when it sends the packet on
+      i->second.seen = Simulator::Now ().GetTimeStep ();
+      return;
+    }
+  FlowHops &f = sampler->m_flows[i->second.flow];
+  f.delivered++;
+  f.hops += i->second.hops;
+  f.maxHops = std::max (f.maxHops, i->second.hops);
+  f.delaySum += Simulator::Now ().GetTimeStep () - stamp.GetTxTime ();
+  sampler->m_paths.erase (i);
+}
+
+bool
+HopSampler::WriteCsv (const std::string &path, const std::string &relaysPath) const
+{
+  std::FILE *f = std::fopen (path.c_str (), "w");
+  std::FILE *r = std::fopen (relaysPath.c_str (), "w");
+  if (f == 0 || r == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << (f == 0 ? path : relaysPath));
+      if (f)
+        {
+          std::fclose (f);
+        }
+      if (r)
+        {
+          std::fclose (r);
+        }
+      return false;
+    }
+  std::fprintf (f, "# one data packet in %u\nflow,source,sink,sampled,delivered,mean_hops,max_hops,mean_delay_s\n", m_sampleEvery);
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      const FlowHops &h = m_flows[i];
+      std::fprintf (f, "%u,%u,%u,%llu,%llu,%.2f,%u,%.6f\n", i, m_specs[i].source, m_specs[i].sink,
+                    (unsigned long long) h.sent, (unsigned long long) h.delivered,
+                    h.delivered ? (double) h.hops / h.delivered : 0.0, h.maxHops,
+                    h.delivered ? TimeStep (h.delaySum).GetSeconds () / h.delivered : 0.0);
+    }
+  std::fclose (f);
+  std::fprintf (r, "# one data packet in %u\nnode,relayed\n", m_sampleEvery);
+  for (uint32_t n = 0; n < m_relayed.size (); n++)
+    {
+      if (m_relayed[n] > 0)
+        {
+          std::fprintf (r, "%u,%llu\n", n, (unsigned long long) m_relayed[n]);
+        }
+    }
+  std::fclose (r);
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_HOP_SAMPLER_H
+#define VANETRC_HOP_SAMPLER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/event-id.h"
+#include "flow-table.h"
+
+namespace ns3 {
+
+/**
+ * Follows one data packet in sampleEvery hop by hop, for diagnosis next
+ * to endpoint-only flow monitoring.
+ *
+ * Every node's IP SendOutgoing, UnicastForward and LocalDeliver traces are
+ * connected, but a packet is only looked at further if its uid is a
+ * multiple of sampleEvery and it carries a FlowStampTag. For each flow it
+ * counts the sampled packets sent and delivered and the IP hops and delay
+ * of the delivered ones; for each node, the sampled packets it relayed.
+ * A packet is only sent at its flow's source and delivered at its sink:
+ * DSR hands data up and sends it again at every relay, which counts as a
+ * relay hop instead.
+ * A sampled packet not seen for longer than AODV and DSR may buffer it
+ * (30 s) is forgotten, so lost packets do not pile up.
+ */
+class HopSampler : public SimpleRefCount<HopSampler>
+{
+public:
+  HopSampler (const FlowTable &flows, uint32_t sampleEvery);
+
+  /// Follow packets through nodes, which must have an internet stack
+  void Install (const NodeContainer &nodes);
+  /// Stop forgetting lost packets
+  void Stop (void);
+
+  /**
+   * Write one row per flow to path and one row per relaying node to
+   * relaysPath.
+   */
+  bool WriteCsv (const std::string &path, const std::string &relaysPath) const;
+
+private:
+  struct FlowHops
+  {
+    uint64_t sent;
+    uint64_t delivered;
+    uint64_t hops;          //!< Sum over the delivered packets
+    uint32_t maxHops;
+    int64_t delaySum;       //!< Time steps
+  };
+
+  struct Path
+  {
+    uint32_t flow;
+    uint32_t hops;
+    int64_t seen;           //!< Time step of the last hop
+  };
+
+  /// Forget the sampled packets not seen for a while
+  void Expire (void);
+
+  static void SendOutgoing (HopSampler *sampler, uint32_t node, const Ipv4Header &header,
+                            Ptr<const Packet> packet, uint32_t interface);
+  static void UnicastForward (HopSampler *sampler, uint32_t node, const Ipv4Header &header,
+                              Ptr<const Packet> packet, uint32_t interface);
+  static void LocalDeliver (HopSampler *sampler, uint32_t node, const Ipv4Header &header,
+                            Ptr<const Packet> packet, uint32_t interface);
+
+  std::vector<FlowSpec> m_specs;
+  uint32_t m_sampleEvery;
+  std::vector<FlowHops> m_flows;
+  /// Sampled packets relayed, by node id
+  std::vector<uint64_t> m_relayed;
+  /// Sampled packets in flight, by uid
+  std::unordered_map<uint64_t, Path> m_paths;
+  EventId m_event;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_HOP_SAMPLER_H */
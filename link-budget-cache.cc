@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "link-budget-cache.h"
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/constant-position-mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LinkBudgetCache");
+
+LinkBudgetCache::LinkBudgetCache (Ptr<PropagationLossModel> loss, Ptr<PropagationDelayModel> delay)
+  : m_loss (loss),
+    m_delay (delay),
+    m_valid (false)
+{
+}
+
+bool
+LinkBudgetCache::Build (const NodeContainer &nodes)
+{
+  NS_LOG_FUNCTION (this << nodes.GetN ());
+  m_valid = false;
+  m_index.clear ();
+  std::vector<Ptr<MobilityModel> > mobility;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<MobilityModel> m = nodes.Get (i)->GetObject<MobilityModel> ();
+      if (DynamicCast<ConstantPositionMobilityModel> (m) == 0)
+        {
+          NS_LOG_WARN ("Node " << nodes.Get (i)->GetId () << " is not constant-position, link budget cache disabled");
+          m_gainDb.clear ();
+          m_delaySteps.clear ();
+          return false;
+        }
+      m_index[PeekPointer (m)] = i;
+      mobility.push_back (m);
+    }
+
+  uint64_t n = mobility.size ();
+  m_gainDb.assign (n * (n - 1) / 2, 0);
+  m_delaySteps.assign (n * (n - 1) / 2, 0);
+  for (uint64_t j = 1; j < n; j++)
+    {
+      for (uint64_t i = 0; i < j; i++)
+        {
+          uint64_t slot = j * (j - 1) / 2 + i;
+          m_gainDb[slot] = m_loss->CalcRxPower (0, mobility[i], mobility[j]);
+          // Whole time steps stay exact in a float up to 2^24 of them
+          m_delaySteps[slot] = m_delay->GetDelay (mobility[i], mobility[j]).GetTimeStep ();
+        }
+    }
+  for (uint64_t i = 0; i < n; i++)
+    {
+      mobility[i]->TraceConnectWithoutContext ("CourseChange", MakeCallback (&LinkBudgetCache::Invalidate, this));
+    }
+  m_valid = true;
+  return true;
+}
+
+bool
+LinkBudgetCache::IsValid (void) const
+{
+  return m_valid;
+}
+
+void
+LinkBudgetCache::Invalidate (Ptr<const MobilityModel> mobility)
+{
+  if (m_valid)
+    {
+      NS_LOG_INFO ("A node moved, link budget cache disabled");
+      m_valid = false;
+      std::vector<float> ().swap (m_gainDb);
+      std::vector<float> ().swap (m_delaySteps);
+    }
+}
+
+int64_t
+LinkBudgetCache::Slot (const MobilityModel *a, const MobilityModel *b) const
+{
+  if (!m_valid)
+    {
+      return -1;
+    }
+  std::unordered_map<const MobilityModel *, uint32_t>::const_iterator ia = m_index.find (a);
+  std::unordered_map<const MobilityModel *, uint32_t>::const_iterator ib = m_index.find (b);
+  if (ia == m_index.end () || ib == m_index.end () || ia->second == ib->second)
+    {
+      return -1;
+    }
+  uint64_t i = std::min (ia->second, ib->second);
+  uint64_t j = std::max (ia->second, ib->second);
+  return j * (j - 1) / 2 + i;
+}
+
+bool
+LinkBudgetCache::GetGain (const MobilityModel *a, const MobilityModel *b, double &gainDb) const
+{
+  int64_t slot = Slot (a, b);
+  if (slot < 0)
+    {
+      return false;
+    }
+  gainDb = m_gainDb[slot];
+  return true;
+}
+
+bool
+LinkBudgetCache::GetDelay (const MobilityModel *a, const MobilityModel *b, Time &delay) const
+{
+  int64_t slot = Slot (a, b);
+  if (slot < 0)
+    {
+      return false;
+    }
+  delay = TimeStep (static_cast<uint64_t> (m_delaySteps[slot]));
+  return true;
+}
+
+Ptr<PropagationLossModel>
+LinkBudgetCache::GetLossModel (void) const
+{
+  return m_loss;
+}
+
+Ptr<PropagationDelayModel>
+LinkBudgetCache::GetDelayModel (void) const
+{
+  return m_delay;
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<CachedPropagationLossModel> ()
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+{
+}
+
+void
+CachedPropagationLossModel::SetCache (Ptr<LinkBudgetCache> cache)
+{
+  m_cache = cache;
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  double gainDb;
+  if (m_cache->GetGain (PeekPointer (a), PeekPointer (b), gainDb))
+    {
+      return txPowerDbm + gainDb;
+    }
+  return m_cache->GetLossModel ()->CalcRxPower (txPowerDbm, a, b);
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return m_cache->GetLossModel ()->AssignStreams (stream);
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationDelayModel);
+
+TypeId
+CachedPropagationDelayModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationDelayModel")
+    .SetParent<PropagationDelayModel> ()
+    .AddConstructor<CachedPropagationDelayModel> ()
+  ;
+  return tid;
+}
+
+CachedPropagationDelayModel::CachedPropagationDelayModel ()
+{
+}
+
+void
+CachedPropagationDelayModel::SetCache (Ptr<LinkBudgetCache> cache)
+{
+  m_cache = cache;
+}
+
+Time
+CachedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  Time delay;
+  if (m_cache->GetDelay (PeekPointer (a), PeekPointer (b), delay))
+    {
+      return delay;
+    }
+  return m_cache->GetDelayModel ()->GetDelay (a, b);
+}
+
+int64_t
+CachedPropagationDelayModel::DoAssignStreams (int64_t stream)
+{
+  return m_cache->GetDelayModel ()->AssignStreams (stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_LINK_BUDGET_CACHE_H
+#define VANETRC_LINK_BUDGET_CACHE_H
+
+#include <unordered_map>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+
+namespace ns3 {
+
+/**
+ * Pairwise gain and delay of a static topology, computed once.
+ *
+ * Both tables are packed lower triangles of floats, n (n - 1) / 2 entries
+ * each, indexed by the position of the nodes in the container given to
+ * Build (). The loss model must be deterministic: a pair's gain is taken
+ * at 0 dBm and added to the actual tx power. Delays are kept in time steps,
+ * which are exact for delays below 2^24 steps (16 ms at the default
+ * nanosecond resolution).
+ *
+ * The cache only builds when every node has a ConstantPositionMobilityModel,
+ * and it drops the tables the first time any of them reports a course
+ * change. From then on lookups fail and the models fall back to computing.
+ */
+class LinkBudgetCache : public SimpleRefCount<LinkBudgetCache>
+{
+public:
+  LinkBudgetCache (Ptr<PropagationLossModel> loss, Ptr<PropagationDelayModel> delay);
+
+  /**
+   * Fill the tables for nodes.
+   *
+   * \return false, leaving the cache invalid, if a node is not constant-position
+   */
+  bool Build (const NodeContainer &nodes);
+  bool IsValid (void) const;
+
+  /**
+   * \return false if the pair is not cached
+   */
+  bool GetGain (const MobilityModel *a, const MobilityModel *b, double &gainDb) const;
+  bool GetDelay (const MobilityModel *a, const MobilityModel *b, Time &delay) const;
+
+  Ptr<PropagationLossModel> GetLossModel (void) const;
+  Ptr<PropagationDelayModel> GetDelayModel (void) const;
+
+private:
+  /// Table slot of the pair, or -1
+  int64_t Slot (const MobilityModel *a, const MobilityModel *b) const;
+  void Invalidate (Ptr<const MobilityModel> mobility);
+
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<PropagationDelayModel> m_delay;
+  std::unordered_map<const MobilityModel *, uint32_t> m_index;
+  std::vector<float> m_gainDb;
+  std::vector<float> m_delaySteps;
+  bool m_valid;
+};
+
+/**
+ * Propagation loss looked up from a LinkBudgetCache, computed by the
+ * cache's own loss model for the pairs it does not hold.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+  CachedPropagationLossModel ();
+
+  void SetCache (Ptr<LinkBudgetCache> cache);
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  Ptr<LinkBudgetCache> m_cache;
+};
+
+/**
+ * Propagation delay looked up from a LinkBudgetCache, computed by the
+ * cache's own delay model for the pairs it does not hold.
+ */
+class CachedPropagationDelayModel : public PropagationDelayModel
+{
+public:
+  static TypeId GetTypeId (void);
+  CachedPropagationDelayModel ();
+
+  void SetCache (Ptr<LinkBudgetCache> cache);
+  virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+private:
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  Ptr<LinkBudgetCache> m_cache;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_LINK_BUDGET_CACHE_H */
@@ -1,13 +0,0 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
-
-#include "modified_Node.h"
-
-namespace ns3{
-
-    uint32_t
-    modified_Node::getCondition()
-    {
-        return condition;
-    }
-    
-}
\ No newline at end of file
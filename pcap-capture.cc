@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "pcap-capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "flow-stats-collector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapCapture");
+
+namespace {
+
+struct PcapFileHeader
+{
+  uint32_t magic;
+  uint16_t versionMajor;
+  uint16_t versionMinor;
+  int32_t thisZone;
+  uint32_t sigFigs;
+  uint32_t snapLen;
+  uint32_t network;
+};
+
+struct PcapRecordHeader
+{
+  uint32_t seconds;
+  uint32_t microseconds;
+  uint32_t inclLen;
+  uint32_t origLen;
+};
+
+const uint32_t LINKTYPE_RAW = 101;
+
+} // anonymous namespace
+
+PcapCapture::PcapCapture (Filter filter, uint32_t snapLen)
+  : m_filter (filter),
+    m_snapLen (snapLen),
+    m_file (0),
+    m_records (0),
+    m_closing (false)
+{
+  NS_ASSERT (snapLen > 0);
+  m_front.reserve (FLUSH_BYTES + snapLen + sizeof (PcapRecordHeader));
+  m_back.reserve (m_front.capacity ());
+  m_scratch.resize (snapLen);
+}
+
+PcapCapture::~PcapCapture ()
+{
+  Close ();
+}
+
+bool
+PcapCapture::ParseFilter (const std::string &name, Filter &filter)
+{
+  if (name == "all")
+    {
+      filter = ALL;
+    }
+  else if (name == "data")
+    {
+      filter = DATA;
+    }
+  else if (name == "control")
+    {
+      filter = CONTROL;
+    }
+  else
+    {
+      return false;
+    }
+  return true;
+}
+
+bool
+PcapCapture::Open (const std::string &path)
+{
+  NS_LOG_FUNCTION (this << path);
+  NS_ASSERT (m_file == 0);
+  m_file = std::fopen (path.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  PcapFileHeader header = { 0xa1b2c3d4, 2, 4, 0, 0, m_snapLen, LINKTYPE_RAW };
+  std::fwrite (&header, sizeof (header), 1, m_file);
+  m_closing = false;
+  m_writer = std::thread (&PcapCapture::Writer, this);
+  return true;
+}
+
+void
+PcapCapture::Install (Ptr<Node> node)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, "Node " << node->GetId () << " has no internet stack");
+  ipv4->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&PcapCapture::Trace, this));
+  ipv4->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&PcapCapture::Trace, this));
+}
+
+void
+PcapCapture::Trace (PcapCapture *capture, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  capture->Record (packet);
+}
+
+void
+PcapCapture::Record (Ptr<const Packet> packet)
+{
+  if (m_filter != ALL)
+    {
+      FlowStampTag stamp;
+      bool data = packet->FindFirstMatchingByteTag (stamp);
+      if (data != (m_filter == DATA))
+        {
+          return;
+        }
+    }
+
+  int64_t us = Simulator::Now ().GetMicroSeconds ();
+  PcapRecordHeader record;
+  record.seconds = us / 1000000;
+  record.microseconds = us % 1000000;
+  record.origLen = packet->GetSize ();
+  record.inclLen = std::min (record.origLen, m_snapLen);
+  packet->CopyData (m_scratch.data (), record.inclLen);
+
+  std::lock_guard<std::mutex> lock (m_mutex);
+  const uint8_t *r = reinterpret_cast<const uint8_t *> (&record);
+  m_front.insert (m_front.end (), r, r + sizeof (record));
+  m_front.insert (m_front.end (), m_scratch.begin (), m_scratch.begin () + record.inclLen);
+  m_records++;
+  if (m_front.size () >= FLUSH_BYTES)
+    {
+      m_ready.notify_one ();
+    }
+}
+
+void
+PcapCapture::Writer (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      m_ready.wait (lock, [this] { return m_closing || m_front.size () >= FLUSH_BYTES; });
+      bool closing = m_closing;
+      m_front.swap (m_back);
+      lock.unlock ();
+      std::fwrite (m_back.data (), 1, m_back.size (), m_file);
+      m_back.clear ();
+      lock.lock ();
+      if (closing)
+        {
+          return;
+        }
+    }
+}
+
+void
+PcapCapture::Close (void)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_closing = true;
+  }
+  m_ready.notify_one ();
+  m_writer.join ();
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+uint64_t
+PcapCapture::GetRecords (void) const
+{
+  return m_records;
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_PCAP_CAPTURE_H
+#define VANETRC_PCAP_CAPTURE_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4.h"
+
+namespace ns3 {
+
+/**
+ * One merged, filtered IPv4 capture of many nodes, written by a thread of
+ * its own.
+ *
+ * The nodes given to Install () have their IPv4 Tx and Rx traces recorded,
+ * as EnablePcapIpv4All does per node, into a single pcap file of raw IP
+ * packets (LINKTYPE_RAW); a packet crossing a hop thus appears once for the
+ * sender and once per receiver. The filter keeps all packets, only the data
+ * packets (the ones carrying a FlowStampTag) or only the control packets,
+ * and at most snapLen bytes of each are kept.
+ *
+ * The simulator thread only appends records to a memory buffer. Once the
+ * buffer holds a megabyte the writer thread takes it and writes it while
+ * the simulation goes on filling a second one.
+ */
+class PcapCapture : public SimpleRefCount<PcapCapture>
+{
+public:
+  enum Filter
+  {
+    ALL,
+    DATA,
+    CONTROL
+  };
+
+  PcapCapture (Filter filter, uint32_t snapLen);
+  ~PcapCapture ();
+
+  /**
+   * Create path, write the pcap header and start the writer thread.
+   *
+   * \return false if path cannot be written
+   */
+  bool Open (const std::string &path);
+  /// Capture the IPv4 traffic of node
+  void Install (Ptr<Node> node);
+  /// Write what is buffered, stop the writer thread and close the file
+  void Close (void);
+
+  /// Packets captured so far
+  uint64_t GetRecords (void) const;
+
+  /// Parse "all", "data" or "control"
+  static bool ParseFilter (const std::string &name, Filter &filter);
+
+private:
+  static void Trace (PcapCapture *capture, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  void Record (Ptr<const Packet> packet);
+  void Writer (void);
+
+  static const uint32_t FLUSH_BYTES = 1 << 20;
+
+  Filter m_filter;
+  uint32_t m_snapLen;
+  std::FILE *m_file;
+  uint64_t m_records;
+  /// Filled by the simulator
+  std::vector<uint8_t> m_front;
+  /// Being written by the writer thread
+  std::vector<uint8_t> m_back;
+  std::vector<uint8_t> m_scratch;
+  std::mutex m_mutex;
+  std::condition_variable m_ready;
+  std::thread m_writer;
+  bool m_closing;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_PCAP_CAPTURE_H */
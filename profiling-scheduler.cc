@@ -0,0 +1,299 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "profiling-scheduler.h"
+
+#ifdef VANETRC_PROFILE
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <cxxabi.h>
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#endif
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/event-impl.h"
+#include "ns3/map-scheduler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProfilingScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingScheduler);
+
+ProfilingScheduler *ProfilingScheduler::s_current = 0;
+
+namespace {
+
+/// Time stamp counter, or steady clock nanoseconds where there is none
+inline uint64_t
+Cycles (void)
+{
+#if defined (__x86_64__) || defined (__i386__)
+  return __rdtsc ();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds> (
+    std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+#endif
+}
+
+const uint32_t NONE = 0xffffffff;
+
+} // anonymous namespace
+
+TypeId
+ProfilingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<ProfilingScheduler> ()
+    .AddAttribute ("SampleInterval",
+                   "Removed events between two queue depth samples",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&ProfilingScheduler::m_sampleInterval),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+ProfilingScheduler::ProfilingScheduler ()
+  : m_scheduler (CreateObject<MapScheduler> ()),
+    m_sampleInterval (1024),
+    m_depth (0),
+    m_maxDepth (0),
+    m_depthSum (0),
+    m_depthSamples (0),
+    m_removals (0),
+    m_running (NONE),
+    m_runningStart (0)
+{
+  s_current = this;
+}
+
+ProfilingScheduler::~ProfilingScheduler ()
+{
+  if (s_current == this)
+    {
+      s_current = 0;
+    }
+}
+
+ProfilingScheduler *
+ProfilingScheduler::GetCurrent (void)
+{
+  return s_current;
+}
+
+std::string
+ProfilingScheduler::SourceName (const std::type_info &type)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (type.name (), 0, 0, &status);
+  std::string name = status == 0 ? demangled : type.name ();
+  std::free (demangled);
+
+  // MakeEvent<void (ns3::Class::*)(...), ...>(...)::EventMemberImpl2 -> ns3::Class
+  std::string::size_type member = name.find ("::*)");
+  if (member != std::string::npos)
+    {
+      std::string::size_type open = name.rfind ('(', member);
+      return name.substr (open + 1, member - open - 1);
+    }
+  // MakeEvent<U1, T1>(void (*)(U1), T1)::EventFunctionImpl1 -> void (*)(U1)
+  std::string::size_type args = name.find (">(");
+  if (name.compare (0, 15, "ns3::MakeEvent<") == 0 && args != std::string::npos)
+    {
+      int depth = 0;
+      for (std::string::size_type i = args + 2; i < name.size (); i++)
+        {
+          char c = name[i];
+          depth += (c == '(' || c == '<') - (c == ')' || c == '>');
+          if (depth < 0 || (depth == 0 && c == ','))
+            {
+              return name.substr (args + 2, i - args - 2);
+            }
+        }
+    }
+  return name;
+}
+
+uint32_t
+ProfilingScheduler::Lookup (const EventImpl *impl)
+{
+  std::type_index type (typeid (*impl));
+  std::unordered_map<std::type_index, uint32_t>::const_iterator i = m_index.find (type);
+  if (i != m_index.end ())
+    {
+      return i->second;
+    }
+  Source source = { SourceName (typeid (*impl)), 0, 0, 0, 0 };
+  m_sources.push_back (source);
+  m_index.insert (std::make_pair (type, (uint32_t) m_sources.size () - 1));
+  return m_sources.size () - 1;
+}
+
+void
+ProfilingScheduler::Insert (const Event &ev)
+{
+  m_sources[Lookup (ev.impl)].scheduled++;
+  m_depth++;
+  m_maxDepth = std::max (m_maxDepth, m_depth);
+  m_scheduler->Insert (ev);
+}
+
+bool
+ProfilingScheduler::IsEmpty (void) const
+{
+  return m_scheduler->IsEmpty ();
+}
+
+Scheduler::Event
+ProfilingScheduler::PeekNext (void) const
+{
+  return m_scheduler->PeekNext ();
+}
+
+Scheduler::Event
+ProfilingScheduler::RemoveNext (void)
+{
+  // The simulator invokes the event it removed before removing the next
+  // one, so the time since the last removal is that event's
+  uint64_t now = Cycles ();
+  if (m_running != NONE)
+    {
+      m_sources[m_running].cycles += now - m_runningStart;
+    }
+  if (++m_removals % m_sampleInterval == 0)
+    {
+      m_depthSum += m_depth;
+      m_depthSamples++;
+    }
+  Event ev = m_scheduler->RemoveNext ();
+  m_depth--;
+  m_running = Lookup (ev.impl);
+  if (ev.impl->IsCancelled ())
+    {
+      m_sources[m_running].cancelled++;
+    }
+  else
+    {
+      m_sources[m_running].executed++;
+    }
+  m_runningStart = Cycles ();
+  return ev;
+}
+
+void
+ProfilingScheduler::Remove (const Event &ev)
+{
+  m_depth--;
+  m_scheduler->Remove (ev);
+}
+
+void
+ProfilingScheduler::Finish (void)
+{
+  if (m_running != NONE)
+    {
+      m_sources[m_running].cycles += Cycles () - m_runningStart;
+      m_running = NONE;
+    }
+}
+
+std::vector<ProfilingScheduler::Source>
+ProfilingScheduler::Summarize (void) const
+{
+  std::map<std::string, Source> merged;
+  for (std::vector<Source>::const_iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      std::map<std::string, Source>::iterator m = merged.find (i->name);
+      if (m == merged.end ())
+        {
+          merged.insert (std::make_pair (i->name, *i));
+          continue;
+        }
+      m->second.scheduled += i->scheduled;
+      m->second.executed += i->executed;
+      m->second.cancelled += i->cancelled;
+      m->second.cycles += i->cycles;
+    }
+  std::vector<Source> sources;
+  for (std::map<std::string, Source>::const_iterator m = merged.begin (); m != merged.end (); ++m)
+    {
+      sources.push_back (m->second);
+    }
+  std::sort (sources.begin (), sources.end (),
+             [] (const Source &a, const Source &b) { return a.cycles > b.cycles; });
+  return sources;
+}
+
+bool
+ProfilingScheduler::WriteReport (const std::string &path) const
+{
+  std::FILE *f = std::fopen (path.c_str (), "w");
+  if (f == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  std::vector<Source> sources = Summarize ();
+  uint64_t cycles = 0;
+  for (std::vector<Source>::const_iterator i = sources.begin (); i != sources.end (); ++i)
+    {
+      cycles += i->cycles;
+    }
+  std::fprintf (f, "# removed events %llu, queue depth mean %.1f max %llu (sampled every %u removals), cycles %llu\n",
+                (unsigned long long) m_removals, m_depthSamples ? (double) m_depthSum / m_depthSamples : 0.0,
+                (unsigned long long) m_maxDepth, m_sampleInterval, (unsigned long long) cycles);
+  std::fprintf (f, "source,scheduled,executed,cancelled,cycles,cycles_per_event,cycle_share\n");
+  for (std::vector<Source>::const_iterator i = sources.begin (); i != sources.end (); ++i)
+    {
+      uint64_t removed = i->executed + i->cancelled;
+      // Quoted, since signatures hold commas
+      std::fprintf (f, "\"%s\",%llu,%llu,%llu,%llu,%.1f,%.4f\n", i->name.c_str (),
+                    (unsigned long long) i->scheduled, (unsigned long long) i->executed,
+                    (unsigned long long) i->cancelled, (unsigned long long) i->cycles,
+                    removed ? (double) i->cycles / removed : 0.0,
+                    cycles ? (double) i->cycles / cycles : 0.0);
+    }
+  std::fclose (f);
+  return true;
+}
+
+void
+ProfilingScheduler::Print (std::ostream &os, uint32_t top) const
+{
+  std::vector<Source> sources = Summarize ();
+  uint64_t cycles = 0;
+  for (std::vector<Source>::const_iterator i = sources.begin (); i != sources.end (); ++i)
+    {
+      cycles += i->cycles;
+    }
+  os << " Removed events: \t" << m_removals << "\n";
+  os << " Queue depth: \t\tmean " << (m_depthSamples ? (double) m_depthSum / m_depthSamples : 0.0)
+     << ", max " << m_maxDepth << "\n";
+  for (uint32_t i = 0; i < sources.size () && i < top; i++)
+    {
+      os << " " << (cycles ? 100.0 * sources[i].cycles / cycles : 0.0) << " %\t"
+         << sources[i].executed << " executed, " << sources[i].cancelled << " cancelled\t"
+         << sources[i].name << "\n";
+    }
+}
+
+} // namespace ns3
+
+#endif /* VANETRC_PROFILE */
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_PROFILING_SCHEDULER_H
+#define VANETRC_PROFILING_SCHEDULER_H
+
+/*
+ * Only built with -DVANETRC_PROFILE (CXXFLAGS="-DVANETRC_PROFILE" ./waf
+ * configure ...); otherwise this header and its translation unit are empty
+ * and the scenario runs on the default scheduler.
+ */
+#ifdef VANETRC_PROFILE
+
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include "ns3/scheduler.h"
+
+namespace ns3 {
+
+/**
+ * Scheduler that profiles the events going through an inner MapScheduler
+ * (the default one).
+ *
+ * Events are counted by source, the dynamic type of their EventImpl: the
+ * class of the member function they call (ns3::aodv::RoutingProtocol for
+ * the HELLO timer, ns3::OnOffApplication for the sends, ...) or the
+ * signature of the plain function. Per source it counts the scheduled,
+ * executed and cancelled events and the cycles spent from the removal of
+ * one of its events to the next removal, i.e. the callback with the
+ * simulator's own overhead, read from the time stamp counter. The queue
+ * depth is sampled every SampleInterval removals.
+ *
+ * The simulator creates its scheduler itself, so the profile of the
+ * current one is reached through GetCurrent ().
+ */
+class ProfilingScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ProfilingScheduler ();
+  virtual ~ProfilingScheduler ();
+
+  // inherited from Scheduler
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+  /// The scheduler of the simulator, 0 if it is not a ProfilingScheduler
+  static ProfilingScheduler *GetCurrent (void);
+
+  /// Charge the cycles since the last removal to its event, e.g. after Run
+  void Finish (void);
+  /// Csv of the sources, most cycles first, after a summary comment
+  bool WriteReport (const std::string &path) const;
+  /// The summary and the top sources by cycles
+  void Print (std::ostream &os, uint32_t top) const;
+
+private:
+  struct Source
+  {
+    std::string name;
+    uint64_t scheduled;
+    uint64_t executed;
+    uint64_t cancelled;
+    uint64_t cycles;
+  };
+
+  uint32_t Lookup (const EventImpl *impl);
+  /// Sources sorted by cycles, merging the types that share a name
+  std::vector<Source> Summarize (void) const;
+  static std::string SourceName (const std::type_info &type);
+
+  Ptr<Scheduler> m_scheduler;
+  std::unordered_map<std::type_index, uint32_t> m_index;
+  std::vector<Source> m_sources;
+  uint32_t m_sampleInterval;
+  uint64_t m_depth;
+  uint64_t m_maxDepth;
+  uint64_t m_depthSum;
+  uint64_t m_depthSamples;
+  uint64_t m_removals;
+  /// Source of the last removed event and the cycle count at its removal
+  uint32_t m_running;
+  uint64_t m_runningStart;
+
+  static ProfilingScheduler *s_current;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_PROFILE */
+
+#endif /* VANETRC_PROFILING_SCHEDULER_H */
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "replication-controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+ReplicationController::ReplicationController (double target, double level, uint32_t minimum)
+  : m_target (target),
+    m_level (level),
+    m_minimum (std::max (minimum, 2u))
+{
+}
+
+void
+ReplicationController::SetJobs (const std::vector<SweepJob> &jobs)
+{
+  m_configs.clear ();
+  m_where.resize (jobs.size ());
+  for (uint32_t i = 0; i < jobs.size (); i++)
+    {
+      uint32_t c = 0;
+      while (c < m_configs.size () && m_configs[c].connections != jobs[i].connections)
+        {
+          c++;
+        }
+      if (c == m_configs.size ())
+        {
+          Config config;
+          config.connections = jobs[i].connections;
+          config.next = 0;
+          config.converged = false;
+          m_configs.push_back (config);
+        }
+      Config &config = m_configs[c];
+      m_where[i] = std::make_pair (c, (uint32_t) config.jobs.size ());
+      config.jobs.push_back (i);
+      config.state.push_back (PENDING);
+      config.results.push_back (RunResult ());
+      config.limit = config.jobs.size ();
+    }
+}
+
+bool
+ReplicationController::Skip (uint32_t job) const
+{
+  return m_where[job].second >= m_configs[m_where[job].first].limit;
+}
+
+bool
+ReplicationController::IsKept (uint32_t job) const
+{
+  const Config &config = m_configs[m_where[job].first];
+  uint32_t seed = m_where[job].second;
+  return seed < config.limit && config.state[seed] == DONE;
+}
+
+bool
+ReplicationController::IsPrecise (const RunningStats &stats) const
+{
+  // A metric that is constant (e.g. no packet ever delivered) is precise
+  return stats.GetHalfWidth (m_level) <= m_target * std::fabs (stats.GetMean ());
+}
+
+void
+ReplicationController::Add (uint32_t job, bool ok, const RunResult &result)
+{
+  Config &config = m_configs[m_where[job].first];
+  uint32_t seed = m_where[job].second;
+  config.state[seed] = ok ? DONE : FAILED;
+  config.results[seed] = result;
+
+  while (config.next < config.limit && config.state[config.next] != PENDING)
+    {
+      if (config.state[config.next] == DONE)
+        {
+          const RunResult &r = config.results[config.next];
+          config.pdf.Add (r.pdf);
+          config.delay.Add (r.delay);
+          config.rxBitrate.Add (r.rxBitrate);
+        }
+      config.next++;
+      if (config.pdf.GetCount () >= m_minimum
+          && IsPrecise (config.pdf) && IsPrecise (config.delay) && IsPrecise (config.rxBitrate))
+        {
+          config.converged = true;
+          config.limit = config.next;
+        }
+    }
+}
+
+void
+ReplicationController::Print (std::ostream &os) const
+{
+  for (std::vector<Config>::const_iterator c = m_configs.begin (); c != m_configs.end (); ++c)
+    {
+      os << "connections=" << c->connections << ": " << c->pdf.GetCount () << " of "
+         << c->jobs.size () << " seeds, " << (c->converged ? "converged" : "not converged")
+         << ", PDF " << c->pdf.GetMean () << " +- " << c->pdf.GetHalfWidth (m_level) << " %"
+         << ", delay " << c->delay.GetMean () << " +- " << c->delay.GetHalfWidth (m_level) << " s"
+         << ", rx bitrate " << c->rxBitrate.GetMean () << " +- " << c->rxBitrate.GetHalfWidth (m_level) << " kbps\n";
+    }
+}
+
+} // namespace ns3
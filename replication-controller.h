@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_REPLICATION_CONTROLLER_H
+#define VANETRC_REPLICATION_CONTROLLER_H
+
+#include <ostream>
+#include <vector>
+#include "run-result.h"
+#include "sweep-runner.h"
+#include "running-stats.h"
+
+namespace ns3 {
+
+/**
+ * Decides how many seeds each connection count of a sweep needs.
+ *
+ * The seeds of a connection count are taken in sweep order, and the
+ * running mean and variance of its PDF, delay and rx bitrate are updated
+ * as the replications end. Once at least the minimum number of seeds has
+ * run and every metric's confidence interval half width is within target
+ * times its mean, the connection count is converged: its remaining seeds
+ * are skipped and only the seeds up to that point are kept.
+ *
+ * Results that arrive out of seed order wait for the ones before them, so
+ * the kept seeds do not depend on worker timing. Replications already
+ * running when their connection count converges still finish, but are not
+ * kept.
+ */
+class ReplicationController
+{
+public:
+  /**
+   * \param target relative confidence interval half width, e.g. 0.05
+   * \param level confidence level, e.g. 0.95
+   * \param minimum seeds run before convergence is tested, at least 2
+   */
+  ReplicationController (double target, double level, uint32_t minimum);
+
+  /// The sweep, in job order
+  void SetJobs (const std::vector<SweepJob> &jobs);
+
+  /// For SweepRunner::SetSkipCallback
+  bool Skip (uint32_t job) const;
+  /// For SweepRunner::SetResultCallback
+  void Add (uint32_t job, bool ok, const RunResult &result);
+
+  /// Whether the result of a finished job is part of the sample
+  bool IsKept (uint32_t job) const;
+
+  /// One line per connection count: seeds kept, convergence, mean +- half width
+  void Print (std::ostream &os) const;
+
+private:
+  enum State
+  {
+    PENDING,
+    DONE,
+    FAILED
+  };
+
+  struct Config
+  {
+    uint32_t connections;
+    std::vector<uint32_t> jobs;     //!< Job indices, in seed order
+    std::vector<State> state;
+    std::vector<RunResult> results;
+    uint32_t next;                  //!< First seed not added to the statistics
+    uint32_t limit;                 //!< Seeds kept, all until converged
+    bool converged;
+    RunningStats pdf;
+    RunningStats delay;
+    RunningStats rxBitrate;
+  };
+
+  bool IsPrecise (const RunningStats &stats) const;
+
+  double m_target;
+  double m_level;
+  uint32_t m_minimum;
+  std::vector<Config> m_configs;
+  /// Per job: its connection count's index in m_configs and its seed's position
+  std::vector<std::pair<uint32_t, uint32_t> > m_where;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_REPLICATION_CONTROLLER_H */
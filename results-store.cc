@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "results-store.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+namespace {
+
+const char g_header[] = RESULTS_SCHEMA "\n" RESULTS_COLUMNS "\n";
+
+/// write () all of buffer, false on error
+bool
+WriteAll (int fd, const char *buffer, size_t size)
+{
+  while (size > 0)
+    {
+      ssize_t n = write (fd, buffer, size);
+      if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          return false;
+        }
+      buffer += n;
+      size -= n;
+    }
+  return true;
+}
+
+} // anonymous namespace
+
+ResultsStore::ResultsStore (const std::string &path)
+  : m_path (path)
+{
+}
+
+const std::string &
+ResultsStore::GetPath (void) const
+{
+  return m_path;
+}
+
+std::string
+ResultsStore::FormatRow (const RunResult &r)
+{
+  char row[1024];
+  std::snprintf (row, sizeof (row),
+                 "%s,%u,%u,%u,%" PRIu64 ",%.10g,%.10g,%.10g,%.10g,%.10g,%.10g,%.10g,%.6g,%" PRIu64 ",%" PRIu64
+                 ",%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n",
+                 r.routing, r.connections, r.seed, r.size, r.dataRate, r.pdf, r.delay, r.rxBitrate,
+                 r.rlTxPackets, r.rlRxPackets, r.rlTxBytes, r.rlRxBytes,
+                 r.wallSeconds, r.events, r.peakRssKb,
+                 r.runSeconds > 0 ? r.events / r.runSeconds : 0,
+                 r.setupSeconds, r.devicesSeconds, r.stackSeconds, r.runSeconds,
+                 r.statsSeconds, r.teardownSeconds);
+  return row;
+}
+
+bool
+ResultsStore::Append (const RunResult &result, std::string &error) const
+{
+  int fd = open (m_path.c_str (), O_RDWR | O_APPEND | O_CREAT, 0644);
+  if (fd < 0)
+    {
+      error = m_path + ": " + std::strerror (errno);
+      return false;
+    }
+  while (flock (fd, LOCK_EX) < 0)
+    {
+      if (errno != EINTR)
+        {
+          error = m_path + ": cannot lock: " + std::strerror (errno);
+          close (fd);
+          return false;
+        }
+    }
+
+  // Checked under the lock, so only one writer creates the header
+  bool ok = true;
+  struct stat st;
+  if (fstat (fd, &st) < 0)
+    {
+      error = m_path + ": " + std::strerror (errno);
+      ok = false;
+    }
+  else if (st.st_size == 0)
+    {
+      ok = WriteAll (fd, g_header, sizeof (g_header) - 1);
+      if (!ok)
+        {
+          error = m_path + ": " + std::strerror (errno);
+        }
+    }
+  else
+    {
+      char existing[sizeof (g_header) - 1];
+      if (pread (fd, existing, sizeof (existing), 0) != (ssize_t) sizeof (existing)
+          || std::memcmp (existing, g_header, sizeof (existing)) != 0)
+        {
+          error = m_path + " is not a results store of schema \"" RESULTS_SCHEMA "\"";
+          ok = false;
+        }
+    }
+  if (ok)
+    {
+      std::string row = FormatRow (result);
+      ok = WriteAll (fd, row.data (), row.size ());
+      if (!ok)
+        {
+          error = m_path + ": " + std::strerror (errno);
+        }
+    }
+  // Closing the descriptor releases the lock
+  close (fd);
+  return ok;
+}
+
+} // namespace ns3
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_RESULTS_STORE_H
+#define VANETRC_RESULTS_STORE_H
+
+#include <string>
+#include "run-result.h"
+
+/*
+ * Results store: a csv file of one row per replication, read by
+ * tools/vanetrc-aggregate and by pandas (read_csv (path, comment='#')).
+ *
+ *   # vanetrc-results 2
+ *   routing,connections,seed,size,rate,pdf,delay,...
+ *   aodv,5,1,25,150000,97.5,0.0123,...
+ *
+ * The first line names the schema and its version, the second the columns
+ * (RESULTS_COLUMNS, in RunResult order, plus events_per_s, the events
+ * over the run time). A new version may add columns; readers look them up
+ * by name. Version 2 added rate, events_per_s and the phase times.
+ */
+
+#define RESULTS_SCHEMA "# vanetrc-results 2"
+#define RESULTS_COLUMNS "routing,connections,seed,size,rate,pdf,delay,rxbitrate," \
+  "rl_tx_pack,rl_rx_pack,rl_tx_bytes,rl_rx_bytes,wall_s,events,peak_rss_kb," \
+  "events_per_s,setup_s,devices_s,stack_s,run_s,stats_s,teardown_s"
+
+namespace ns3 {
+
+/**
+ * Appends RunResult rows to a results store.
+ *
+ * Every append takes an exclusive flock on the file, writes the schema and
+ * column lines if the file is empty (or checks them otherwise) and then the
+ * row with a single write (), so any number of processes, on one host or
+ * sharing the file over a filesystem with working flock, can append to the
+ * same store without interleaving rows.
+ */
+class ResultsStore
+{
+public:
+  explicit ResultsStore (const std::string &path);
+
+  /**
+   * Append one row.
+   *
+   * \param error set to the reason when nothing was written
+   * \return false if the file cannot be written or holds another schema
+   */
+  bool Append (const RunResult &result, std::string &error) const;
+
+  const std::string &GetPath (void) const;
+
+  /// The csv row of a result, with its newline
+  static std::string FormatRow (const RunResult &result);
+
+private:
+  std::string m_path;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_RESULTS_STORE_H */
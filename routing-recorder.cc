@@ -0,0 +1,334 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "routing-recorder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/output-stream-wrapper.h"
+#include "flow-stats-collector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RoutingRecorder");
+
+RoutingRecorder::RoutingRecorder (const std::string &protocol)
+  : m_protocol (protocol),
+    m_file (0),
+    m_records (0)
+{
+  // Hop count column of PrintRoutingTable (); AODV: Destination Gateway
+  // Interface Flag Expire Hops, OLSR: Destination NextHop Interface
+  // Distance, DSDV: Destination Gateway Interface HopCount ...
+  if (protocol == "aodv" || protocol == "aodv-cond")
+    {
+      m_hopColumn = 5;
+    }
+  else if (protocol == "olsr" || protocol == "dsdv")
+    {
+      m_hopColumn = 3;
+    }
+  else
+    {
+      m_hopColumn = -1;
+    }
+}
+
+RoutingRecorder::~RoutingRecorder ()
+{
+  if (m_file)
+    {
+      std::fclose (m_file);
+    }
+}
+
+bool
+RoutingRecorder::Start (const std::string &path, const NodeContainer &nodes, Time interval)
+{
+  NS_LOG_FUNCTION (this << path << interval);
+  NS_ASSERT (interval.IsStrictlyPositive () && m_file == 0);
+  m_file = std::fopen (path.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  RoutingSnapshotHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, ROUTING_SNAPSHOT_MAGIC, sizeof (ROUTING_SNAPSHOT_MAGIC));
+  header.version = ROUTING_SNAPSHOT_VERSION;
+  header.nodes = nodes.GetN ();
+  std::strncpy (header.protocol, m_protocol.c_str (), sizeof (header.protocol) - 1);
+  header.interval = interval.GetSeconds ();
+  std::fwrite (&header, sizeof (header), 1, m_file);
+
+  m_nodes = nodes;
+  m_interval = interval;
+  m_tables.assign (nodes.GetN (), std::vector<Route> ());
+  m_dirty.assign (nodes.GetN (), 1);
+  for (uint32_t n = 0; n < nodes.GetN (); n++)
+    {
+      Ptr<Ipv4> ipv4 = nodes.Get (n)->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol> (ipv4->GetRoutingProtocol ());
+      if (olsr)
+        {
+          olsr->TraceConnectWithoutContext ("RoutingTableChanged",
+                                            MakeBoundCallback (&RoutingRecorder::TableChanged, this, n));
+          continue;
+        }
+      Ptr<Ipv4L3Protocol> l3 = nodes.Get (n)->GetObject<Ipv4L3Protocol> ();
+      if (l3)
+        {
+          l3->TraceConnectWithoutContext ("SendOutgoing", MakeBoundCallback (&RoutingRecorder::Touch, this, n));
+          l3->TraceConnectWithoutContext ("LocalDeliver", MakeBoundCallback (&RoutingRecorder::Touch, this, n));
+        }
+    }
+  Record (true);
+  m_event = Simulator::Schedule (m_interval, &RoutingRecorder::Tick, this);
+  return true;
+}
+
+void
+RoutingRecorder::Stop (void)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  Record (false);
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+uint64_t
+RoutingRecorder::GetRecords (void) const
+{
+  return m_records;
+}
+
+void
+RoutingRecorder::SetEventLog (Ptr<EventLog> log)
+{
+  m_eventLog = log;
+}
+
+void
+RoutingRecorder::Tick (void)
+{
+  Record (false);
+  m_event = Simulator::Schedule (m_interval, &RoutingRecorder::Tick, this);
+}
+
+void
+RoutingRecorder::Touch (RoutingRecorder *recorder, uint32_t index, const Ipv4Header &header,
+                        Ptr<const Packet> packet, uint32_t interface)
+{
+  FlowStampTag stamp;
+  if (!packet->FindFirstMatchingByteTag (stamp))
+    {
+      recorder->m_dirty[index] = 1;
+    }
+}
+
+void
+RoutingRecorder::TableChanged (RoutingRecorder *recorder, uint32_t index, uint32_t size)
+{
+  recorder->m_dirty[index] = 1;
+}
+
+bool
+RoutingRecorder::ParseAddress (const std::string &token, uint32_t &address)
+{
+  const char *p = token.c_str ();
+  address = 0;
+  for (int i = 0; i < 4; i++)
+    {
+      char *end;
+      unsigned long byte = std::strtoul (p, &end, 10);
+      if (end == p || byte > 255 || *end != (i < 3 ? '.' : '\0'))
+        {
+          return false;
+        }
+      address = (address << 8) | byte;
+      p = end + 1;
+    }
+  return true;
+}
+
+void
+RoutingRecorder::ReadTable (uint32_t index, std::vector<Route> &routes)
+{
+  routes.clear ();
+  Ptr<Ipv4> ipv4 = m_nodes.Get (index)->GetObject<Ipv4> ();
+  if (ipv4 == 0 || ipv4->GetRoutingProtocol () == 0)
+    {
+      return;
+    }
+  Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol> (ipv4->GetRoutingProtocol ());
+  if (olsr)
+    {
+      ReadOlsrTable (olsr, routes);
+      return;
+    }
+  m_text.str ("");
+  m_text.clear ();
+  ipv4->GetRoutingProtocol ()->PrintRoutingTable (Create<OutputStreamWrapper> (&m_text));
+
+  std::string line, token;
+  std::vector<std::string> tokens;
+  while (std::getline (m_text, line))
+    {
+      std::istringstream fields (line);
+      tokens.clear ();
+      while (fields >> token)
+        {
+          tokens.push_back (token);
+        }
+      Route route;
+      if (tokens.size () < 2 || !ParseAddress (tokens[0], route.destination))
+        {
+          continue;
+        }
+      if (!ParseAddress (tokens[1], route.gateway))
+        {
+          route.gateway = 0;
+        }
+      route.hops = 0;
+      if (m_hopColumn >= 0 && (int) tokens.size () > m_hopColumn)
+        {
+          route.hops = std::strtoul (tokens[m_hopColumn].c_str (), 0, 10);
+        }
+      route.state = ROUTE_VALID;
+      if (tokens.size () > 3 && tokens[3] == "DOWN")
+        {
+          route.state = ROUTE_INVALID;
+        }
+      else if (tokens.size () > 3 && tokens[3] == "IN_SEARCH")
+        {
+          route.state = ROUTE_IN_SEARCH;
+        }
+      routes.push_back (route);
+    }
+  std::sort (routes.begin (), routes.end (),
+             [] (const Route &a, const Route &b) { return a.destination < b.destination; });
+}
+
+void
+RoutingRecorder::ReadOlsrTable (Ptr<olsr::RoutingProtocol> olsr, std::vector<Route> &routes)
+{
+  std::vector<olsr::RoutingTableEntry> entries = olsr->GetRoutingTableEntries ();
+  for (std::vector<olsr::RoutingTableEntry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      Route route;
+      route.destination = i->destAddr.Get ();
+      route.gateway = i->nextAddr.Get ();
+      route.hops = i->distance;
+      route.state = ROUTE_VALID;
+      routes.push_back (route);
+    }
+  std::sort (routes.begin (), routes.end (),
+             [] (const Route &a, const Route &b) { return a.destination < b.destination; });
+}
+
+void
+RoutingRecorder::Record (bool full)
+{
+  m_block.clear ();
+  for (uint32_t n = 0; n < m_nodes.GetN (); n++)
+    {
+      if (!full && !m_dirty[n])
+        {
+          continue;
+        }
+      m_dirty[n] = 0;
+      ReadTable (n, m_current);
+      const std::vector<Route> &last = m_tables[n];
+      uint32_t node = m_nodes.Get (n)->GetId ();
+      std::vector<Route>::const_iterator a = last.begin (), b = m_current.begin ();
+      while (a != last.end () || b != m_current.end ())
+        {
+          RouteRecord r;
+          if (b == m_current.end () || (a != last.end () && a->destination < b->destination))
+            {
+              r.op = ROUTE_REMOVE;
+              r.destination = a->destination;
+              r.gateway = a->gateway;
+              r.hops = a->hops;
+              r.state = a->state;
+              ++a;
+            }
+          else
+            {
+              if (a == last.end () || b->destination < a->destination)
+                {
+                  r.op = ROUTE_ADD;
+                }
+              else
+                {
+                  bool same = a->gateway == b->gateway && a->hops == b->hops && a->state == b->state;
+                  ++a;
+                  if (same)
+                    {
+                      ++b;
+                      continue;
+                    }
+                  r.op = ROUTE_CHANGE;
+                }
+              r.destination = b->destination;
+              r.gateway = b->gateway;
+              r.hops = b->hops;
+              r.state = b->state;
+              ++b;
+            }
+          r.node = node;
+          m_block.push_back (r);
+        }
+      m_tables[n].swap (m_current);
+    }
+
+  if (m_block.empty () && !full)
+    {
+      return;
+    }
+  RoutingBlockHeader block;
+  block.time = Simulator::Now ().GetSeconds ();
+  block.records = m_block.size ();
+  block.full = full ? 1 : 0;
+  std::fwrite (&block, sizeof (block), 1, m_file);
+  std::fwrite (m_block.data (), sizeof (RouteRecord), m_block.size (), m_file);
+  m_records += m_block.size ();
+  if (m_eventLog)
+    {
+      uint32_t ops[3] = { 0, 0, 0 };
+      for (std::vector<RouteRecord>::const_iterator r = m_block.begin (); r != m_block.end (); ++r)
+        {
+          ops[r->op == ROUTE_ADD ? 0 : r->op == ROUTE_CHANGE ? 1 : 2]++;
+        }
+      m_eventLog->Add (EVENT_ROUTE_DIFF, ops[0], ops[1], ops[2], full ? 1 : 0);
+    }
+}
+
+} // namespace ns3
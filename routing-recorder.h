@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_ROUTING_RECORDER_H
+#define VANETRC_ROUTING_RECORDER_H
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/olsr-routing-protocol.h"
+#include "routing-snapshot-format.h"
+#include "event-log.h"
+
+namespace ns3 {
+
+/**
+ * Records the routing tables of every node as one full binary snapshot
+ * followed by diffs (see routing-snapshot-format.h).
+ *
+ * Every interval only the nodes whose table may have changed are read
+ * again. OLSR tables are copied from GetRoutingTableEntries () of the nodes
+ * whose RoutingTableChanged trace fired. AODV and DSDV keep their tables
+ * private and report no changes, so a node is read when it sent or
+ * received routing traffic since the last interval; its table is printed
+ * into a reused in-memory stream and parsed back: a line starting with an
+ * IPv4 address is a route, the next address is its gateway, and the
+ * protocol's hop column and AODV's flag complete it. Expiry times are
+ * ignored, so a route only shows up in a diff when its gateway, hop count
+ * or state changes, and a route that only expired shows up at the node's
+ * next routing packet.
+ */
+class RoutingRecorder : public SimpleRefCount<RoutingRecorder>
+{
+public:
+  /// \param protocol aodv, aodv-cond, olsr, dsdv or dsr
+  explicit RoutingRecorder (const std::string &protocol);
+  ~RoutingRecorder ();
+
+  /**
+   * Open path, write the full snapshot of nodes now and a diff every
+   * interval.
+   *
+   * \return false if path cannot be written
+   */
+  bool Start (const std::string &path, const NodeContainer &nodes, Time interval);
+  /// Write a last diff and close the file
+  void Stop (void);
+
+  /// Records written so far
+  uint64_t GetRecords (void) const;
+  /// Also log every block written as an EVENT_ROUTE_DIFF
+  void SetEventLog (Ptr<EventLog> log);
+
+private:
+  struct Route
+  {
+    uint32_t destination;
+    uint32_t gateway;
+    uint16_t hops;
+    uint8_t state;
+  };
+
+  void Tick (void);
+  /// Mark the node at index to be read at the next interval
+  static void Touch (RoutingRecorder *recorder, uint32_t index, const Ipv4Header &header,
+                     Ptr<const Packet> packet, uint32_t interface);
+  static void TableChanged (RoutingRecorder *recorder, uint32_t index, uint32_t size);
+  /// Diff every node's table against the last one and write the block
+  void Record (bool full);
+  /// Parse the table of a node into routes sorted by destination
+  void ReadTable (uint32_t index, std::vector<Route> &routes);
+  /// ReadTable () of an OLSR node, straight from its table entries
+  static void ReadOlsrTable (Ptr<olsr::RoutingProtocol> olsr, std::vector<Route> &routes);
+  static bool ParseAddress (const std::string &token, uint32_t &address);
+
+  std::string m_protocol;
+  int m_hopColumn;
+  NodeContainer m_nodes;
+  Time m_interval;
+  EventId m_event;
+  std::FILE *m_file;
+  uint64_t m_records;
+  std::vector<std::vector<Route> > m_tables;
+  /// Nodes, by index, whose table may have changed since it was last read
+  std::vector<uint8_t> m_dirty;
+  std::vector<Route> m_current;
+  std::vector<RouteRecord> m_block;
+  std::stringstream m_text;
+  Ptr<EventLog> m_eventLog;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_ROUTING_RECORDER_H */
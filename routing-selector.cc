@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "routing-selector.h"
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/traffic-control-helper.h"
+#include "condition-rreq-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RoutingSelector");
+
+RoutingSelector::RoutingSelector ()
+  : m_protocol ("aodv")
+{
+}
+
+bool
+RoutingSelector::SetProtocol (const std::string &name)
+{
+  if (name != "aodv" && name != "aodv-cond" && name != "olsr" && name != "dsdv" && name != "dsr")
+    {
+      return false;
+    }
+  m_protocol = name;
+  return true;
+}
+
+std::string
+RoutingSelector::GetProtocol (void) const
+{
+  return m_protocol;
+}
+
+AodvHelper &
+RoutingSelector::GetAodv (void)
+{
+  return m_aodv;
+}
+
+OlsrHelper &
+RoutingSelector::GetOlsr (void)
+{
+  return m_olsr;
+}
+
+DsdvHelper &
+RoutingSelector::GetDsdv (void)
+{
+  return m_dsdv;
+}
+
+void
+RoutingSelector::SetStateTable (Ptr<const VehicleStateTable> states)
+{
+  m_states = states;
+}
+
+Ipv4RoutingHelper *
+RoutingSelector::GetIpv4Helper (void)
+{
+  if (m_protocol == "olsr")
+    {
+      return &m_olsr;
+    }
+  if (m_protocol == "dsdv")
+    {
+      return &m_dsdv;
+    }
+  if (m_protocol == "dsr")
+    {
+      return 0;
+    }
+  return &m_aodv;
+}
+
+void
+RoutingSelector::GetSuppressedRreqs (uint64_t &packets, uint64_t &bytes) const
+{
+  packets = 0;
+  bytes = 0;
+  for (QueueDiscContainer::ConstIterator i = m_queueDiscs.Begin (); i != m_queueDiscs.End (); ++i)
+    {
+      Ptr<ConditionRreqQueueDisc> qd = DynamicCast<ConditionRreqQueueDisc> (*i);
+      packets += qd->GetSuppressedPackets ();
+      bytes += qd->GetSuppressedBytes ();
+    }
+}
+
+void
+RoutingSelector::Install (InternetStackHelper &stack, NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this << m_protocol);
+  Ipv4RoutingHelper *helper = GetIpv4Helper ();
+  if (helper)
+    {
+      stack.SetRoutingHelper (*helper); // has effect on the next Install ()
+      stack.Install (nodes);
+      if (m_protocol == "aodv-cond")
+        {
+          // Installed before addresses are assigned, so the devices do not
+          // get the default queue disc
+          NS_ABORT_MSG_IF (m_states == 0, "aodv-cond needs the vehicle state table");
+          TrafficControlHelper tch;
+          tch.SetRootQueueDisc ("ns3::ConditionRreqQueueDisc");
+          for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); ++n)
+            {
+              // Device 0 is the loopback
+              for (uint32_t d = 1; d < (*n)->GetNDevices (); d++)
+                {
+                  QueueDiscContainer qd = tch.Install ((*n)->GetDevice (d));
+                  DynamicCast<ConditionRreqQueueDisc> (qd.Get (0))->SetNode (*n, m_states);
+                  m_queueDiscs.Add (qd);
+                }
+            }
+        }
+      return;
+    }
+  stack.Install (nodes);
+  m_dsrMain.Install (m_dsr, nodes);
+}
+
+void
+RoutingSelector::PrintRoutingTableAllAt (Time printTime, Ptr<OutputStreamWrapper> stream)
+{
+  Ipv4RoutingHelper *helper = GetIpv4Helper ();
+  if (helper)
+    {
+      helper->PrintRoutingTableAllAt (printTime, stream);
+    }
+}
+
+} // namespace ns3
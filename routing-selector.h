@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_ROUTING_SELECTOR_H
+#define VANETRC_ROUTING_SELECTOR_H
+
+#include <string>
+#include "ns3/aodv-helper.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/dsdv-helper.h"
+#include "ns3/dsr-helper.h"
+#include "ns3/dsr-main-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/queue-disc-container.h"
+#include "vehicle-state-table.h"
+
+namespace ns3 {
+
+/**
+ * The routing protocol of a run, chosen at runtime.
+ *
+ * AODV, OLSR and DSDV are Ipv4RoutingHelpers handed to the internet stack;
+ * DSR is not an IPv4 routing protocol and is installed on top of the
+ * stack's default routing instead. "aodv-cond" is AODV with a
+ * ConditionRreqQueueDisc on every device, which gossips RREQ rebroadcasts
+ * by node condition. Each helper can still be configured through its
+ * getter before Install ().
+ */
+class RoutingSelector
+{
+public:
+  RoutingSelector ();
+
+  /**
+   * \param name aodv, aodv-cond, olsr, dsdv or dsr
+   * \return false if the name is unknown
+   */
+  bool SetProtocol (const std::string &name);
+  std::string GetProtocol (void) const;
+
+  AodvHelper &GetAodv (void);
+  OlsrHelper &GetOlsr (void);
+  DsdvHelper &GetDsdv (void);
+
+  /// Node conditions read by aodv-cond; must be set before Install ()
+  void SetStateTable (Ptr<const VehicleStateTable> states);
+
+  /// Install the internet stack with the selected protocol on nodes
+  void Install (InternetStackHelper &stack, NodeContainer nodes);
+
+  /// Dump every node's routing table at printTime; DSR has none to dump
+  void PrintRoutingTableAllAt (Time printTime, Ptr<OutputStreamWrapper> stream);
+
+  /// RREQ rebroadcasts suppressed by aodv-cond, and their IP bytes
+  void GetSuppressedRreqs (uint64_t &packets, uint64_t &bytes) const;
+
+private:
+  /// The selected helper, 0 for DSR
+  Ipv4RoutingHelper *GetIpv4Helper (void);
+
+  std::string m_protocol;
+  AodvHelper m_aodv;
+  OlsrHelper m_olsr;
+  DsdvHelper m_dsdv;
+  DsrHelper m_dsr;
+  DsrMainHelper m_dsrMain;
+  QueueDiscContainer m_queueDiscs;
+  Ptr<const VehicleStateTable> m_states;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_ROUTING_SELECTOR_H */
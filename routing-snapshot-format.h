@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_ROUTING_SNAPSHOT_FORMAT_H
+#define VANETRC_ROUTING_SNAPSHOT_FORMAT_H
+
+#include <stdint.h>
+
+/*
+ * Routing tables of every node over a run, written by RoutingRecorder and
+ * read by tools/vanetrc-routes. Host byte order.
+ *
+ *   RoutingSnapshotHeader
+ *   blocks until the end of the file, each
+ *     RoutingBlockHeader
+ *     RouteRecord records[block.records]
+ *
+ * The first block is a full snapshot (every route an ADD); each later one
+ * only holds the routes added, changed or removed since the block before.
+ * Blocks without a change are not written. A table at time t is the full
+ * snapshot with every block up to t applied in order.
+ */
+
+#define ROUTING_SNAPSHOT_MAGIC "VRCRTS1"
+#define ROUTING_SNAPSHOT_VERSION 1
+
+enum RouteOp
+{
+  ROUTE_ADD = 0,
+  ROUTE_CHANGE = 1,
+  ROUTE_REMOVE = 2
+};
+
+enum RouteState
+{
+  ROUTE_VALID = 0,
+  ROUTE_INVALID = 1,        //!< AODV DOWN
+  ROUTE_IN_SEARCH = 2       //!< AODV IN_SEARCH
+};
+
+struct RoutingSnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nodes;
+  char protocol[16];       //!< NUL terminated
+  double interval;         //!< s between diffs
+};
+
+struct RoutingBlockHeader
+{
+  double time;             //!< s
+  uint32_t records;
+  uint32_t full;           //!< 1 for the full snapshot
+};
+
+struct RouteRecord
+{
+  uint32_t node;
+  uint32_t destination;    //!< IPv4 address, host order
+  uint32_t gateway;        //!< IPv4 address, host order
+  uint16_t hops;
+  uint8_t state;           //!< RouteState
+  uint8_t op;              //!< RouteOp
+};
+
+static_assert (sizeof (RoutingSnapshotHeader) == 40, "RoutingSnapshotHeader layout");
+static_assert (sizeof (RoutingBlockHeader) == 16, "RoutingBlockHeader layout");
+static_assert (sizeof (RouteRecord) == 16, "RouteRecord layout");
+
+#endif /* VANETRC_ROUTING_SNAPSHOT_FORMAT_H */
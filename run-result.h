@@ -0,0 +1,55 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_RUN_RESULT_H
+#define VANETRC_RUN_RESULT_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * Metrics of one RoutingExample replication.
+ *
+ * Kept as plain data so that a worker process can hand it to the sweep
+ * parent with a single write() on a pipe.
+ */
+struct RunResult
+{
+  char routing[16];       //!< Routing protocol name, NUL terminated
+  uint32_t connections;
+  uint32_t seed;
+  uint32_t size;
+  uint64_t dataRate;      //!< Data rate of each flow, bit/s
+  double pdf;             //!< Packet delivery fraction of the data flows, %
+  double rxBitrate;       //!< Sum of the data flows' rx bitrate, kbps
+  double delay;           //!< Mean end-to-end delay of the data packets, s
+  double rlTxPackets;     //!< Routing load, control tx packets / data tx packets
+  double rlRxPackets;     //!< Routing load, control rx packets / data rx packets
+  double rlTxBytes;       //!< Routing load, control tx bytes / data tx bytes
+  double rlRxBytes;       //!< Routing load, control rx bytes / data rx bytes
+  double wallSeconds;     //!< Wall-clock time of the replication
+  uint64_t events;        //!< Simulator events executed
+  uint64_t peakRssKb;     //!< Peak resident set size of the process
+  // Wall-clock time of the phases of the replication, s
+  double setupSeconds;    //!< Network and traffic set up, up to Simulator::Run
+  double devicesSeconds;  //!< createDevices, part of the set up
+  double stackSeconds;    //!< installInternetStack, part of the set up
+  double runSeconds;      //!< Simulator::Run
+  double statsSeconds;    //!< Closing the traces and the metrics post-pass
+  double teardownSeconds; //!< Simulator::Destroy
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_RUN_RESULT_H */
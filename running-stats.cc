@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "running-stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * P (|T| < t) of Student's t with integer df (Abramowitz and Stegun
+ * 26.7.3 and 26.7.4), exact in about df / 2 terms.
+ */
+double
+StudentTCentral (double t, uint64_t df)
+{
+  double theta = std::atan (t / std::sqrt ((double) df));
+  double c = std::cos (theta), s = std::sin (theta), c2 = c * c;
+  if (df % 2 == 0)
+    {
+      double term = 1, sum = 1;
+      for (uint64_t k = 2; k + 2 <= df; k += 2)
+        {
+          term *= c2 * (k - 1) / k;
+          sum += term;
+        }
+      return s * sum;
+    }
+  if (df == 1)
+    {
+      return 2 * theta / M_PI;
+    }
+  double term = c, sum = c;
+  for (uint64_t k = 3; k + 2 <= df; k += 2)
+    {
+      term *= c2 * (k - 1) / k;
+      sum += term;
+    }
+  return 2 / M_PI * (theta + s * sum);
+}
+
+/// Root of increasing f (x) = target on x >= 0 by bisection
+template <typename F>
+double
+Bisect (F f, double target)
+{
+  double lo = 0, hi = 1;
+  while (f (hi) < target && hi < 1e12)
+    {
+      lo = hi;
+      hi *= 2;
+    }
+  for (int i = 0; i < 200 && hi - lo > 1e-12 * hi; i++)
+    {
+      double mid = (lo + hi) / 2;
+      (f (mid) < target ? lo : hi) = mid;
+    }
+  return (lo + hi) / 2;
+}
+
+} // anonymous namespace
+
+RunningStats::RunningStats ()
+  : m_count (0),
+    m_mean (0),
+    m_m2 (0),
+    m_min (0),
+    m_max (0)
+{
+}
+
+void
+RunningStats::Add (double x)
+{
+  m_count++;
+  double delta = x - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (x - m_mean);
+  m_min = m_count == 1 ? x : std::min (m_min, x);
+  m_max = m_count == 1 ? x : std::max (m_max, x);
+}
+
+uint64_t
+RunningStats::GetCount (void) const
+{
+  return m_count;
+}
+
+double
+RunningStats::GetMean (void) const
+{
+  return m_mean;
+}
+
+double
+RunningStats::GetVariance (void) const
+{
+  return m_count > 1 ? m_m2 / (m_count - 1) : 0;
+}
+
+double
+RunningStats::GetStddev (void) const
+{
+  return std::sqrt (GetVariance ());
+}
+
+double
+RunningStats::GetMin (void) const
+{
+  return m_min;
+}
+
+double
+RunningStats::GetMax (void) const
+{
+  return m_max;
+}
+
+double
+RunningStats::GetHalfWidth (double level) const
+{
+  if (m_count < 2)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return StudentTQuantile ((1 + level) / 2, m_count - 1) * GetStddev () / std::sqrt ((double) m_count);
+}
+
+P2Quantile::P2Quantile (double p, uint32_t exactValues)
+  : m_p (p),
+    m_count (0),
+    m_exactValues (std::max<uint32_t> (exactValues, 5))
+{
+  m_dn[0] = 0;
+  m_dn[1] = p / 2;
+  m_dn[2] = p;
+  m_dn[3] = (1 + p) / 2;
+  m_dn[4] = 1;
+}
+
+void
+P2Quantile::StartMarkers (void)
+{
+  double last = m_values.size ();
+  for (int i = 0; i < 5; i++)
+    {
+      m_np[i] = 1 + (last - 1) * m_dn[i];
+      // Nearest order statistic, leaving room for the other markers
+      double n = std::floor (m_np[i] + 0.5);
+      n = std::max (n, i == 0 ? 1 : m_n[i - 1] + 1);
+      n = std::min (n, last - (4 - i));
+      m_n[i] = n;
+      m_q[i] = m_values[(size_t) n - 1];
+    }
+  std::vector<double> ().swap (m_values);
+}
+
+void
+P2Quantile::Add (double x)
+{
+  if (m_count <= m_exactValues)
+    {
+      m_values.insert (std::upper_bound (m_values.begin (), m_values.end (), x), x);
+      if (++m_count > m_exactValues)
+        {
+          StartMarkers ();
+        }
+      return;
+    }
+  m_count++;
+
+  int k;
+  if (x < m_q[0])
+    {
+      m_q[0] = x;
+      k = 0;
+    }
+  else if (x >= m_q[4])
+    {
+      m_q[4] = x;
+      k = 3;
+    }
+  else
+    {
+      k = 0;
+      while (x >= m_q[k + 1])
+        {
+          k++;
+        }
+    }
+  for (int i = k + 1; i < 5; i++)
+    {
+      m_n[i]++;
+    }
+  for (int i = 0; i < 5; i++)
+    {
+      m_np[i] += m_dn[i];
+    }
+
+  for (int i = 1; i < 4; i++)
+    {
+      double d = m_np[i] - m_n[i];
+      if ((d >= 1 && m_n[i + 1] - m_n[i] > 1) || (d <= -1 && m_n[i - 1] - m_n[i] < -1))
+        {
+          int s = d > 0 ? 1 : -1;
+          // Piecewise parabolic prediction, linear if it leaves the neighbours
+          double q = m_q[i] + s / (m_n[i + 1] - m_n[i - 1])
+            * ((m_n[i] - m_n[i - 1] + s) * (m_q[i + 1] - m_q[i]) / (m_n[i + 1] - m_n[i])
+               + (m_n[i + 1] - m_n[i] - s) * (m_q[i] - m_q[i - 1]) / (m_n[i] - m_n[i - 1]));
+          if (q <= m_q[i - 1] || q >= m_q[i + 1])
+            {
+              q = m_q[i] + s * (m_q[i + s] - m_q[i]) / (m_n[i + s] - m_n[i]);
+            }
+          m_q[i] = q;
+          m_n[i] += s;
+        }
+    }
+}
+
+double
+P2Quantile::Get (void) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  if (m_count <= m_exactValues)
+    {
+      double rank = m_p * (m_count - 1);
+      uint64_t i = (uint64_t) rank;
+      return i + 1 < m_count ? m_values[i] + (rank - i) * (m_values[i + 1] - m_values[i]) : m_values[i];
+    }
+  return m_q[2];
+}
+
+double
+StudentTQuantile (double p, uint64_t df)
+{
+  if (p < 0.5)
+    {
+      return -StudentTQuantile (1 - p, df);
+    }
+  if (df > 1000)
+    {
+      // Cornish-Fisher expansion around the normal quantile
+      double z = Bisect ([] (double x) { return std::erf (x / std::sqrt (2.0)); }, 2 * p - 1);
+      double v = df, z2 = z * z;
+      return z + z * (z2 + 1) / (4 * v)
+        + z * ((5 * z2 + 16) * z2 + 3) / (96 * v * v)
+        + z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / (384 * v * v * v);
+    }
+  return Bisect ([df] (double t) { return StudentTCentral (t, df); }, 2 * p - 1);
+}
+
+} // namespace ns3
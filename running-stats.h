@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_RUNNING_STATS_H
+#define VANETRC_RUNNING_STATS_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Streaming mean, variance and confidence interval of a sample (Welford's
+ * update), in constant memory.
+ */
+class RunningStats
+{
+public:
+  RunningStats ();
+
+  void Add (double x);
+
+  uint64_t GetCount (void) const;
+  double GetMean (void) const;
+  /// Sample variance, 0 below two values
+  double GetVariance (void) const;
+  double GetStddev (void) const;
+  double GetMin (void) const;
+  double GetMax (void) const;
+  /**
+   * Half width of the Student t confidence interval of the mean at level
+   * (0.95 for 95 %), infinite below two values.
+   */
+  double GetHalfWidth (double level) const;
+
+private:
+  uint64_t m_count;
+  double m_mean;
+  double m_m2;
+  double m_min;
+  double m_max;
+};
+
+/**
+ * Streaming estimate of one quantile with the P² algorithm (Jain and
+ * Chlamtac, 1985): five markers, constant memory.
+ *
+ * P² is poor on a few dozen values, so the first exactValues are kept
+ * sorted and the quantile is interpolated between them exactly (the
+ * p (n - 1) rank, as R's default). The value after that starts the
+ * markers at the matching order statistics of the kept values, which are
+ * then released.
+ */
+class P2Quantile
+{
+public:
+  /**
+   * \param p the quantile, in (0, 1)
+   * \param exactValues values kept for the exact quantile, at least 5
+   */
+  explicit P2Quantile (double p, uint32_t exactValues = 512);
+
+  void Add (double x);
+  /// The estimate, 0 before the first value
+  double Get (void) const;
+
+private:
+  /// Place the markers on the sorted kept values and release them
+  void StartMarkers (void);
+
+  double m_p;
+  uint64_t m_count;
+  uint32_t m_exactValues;
+  std::vector<double> m_values; //!< Sorted values until the markers start
+  double m_q[5];        //!< Marker heights
+  double m_n[5];        //!< Marker positions, 1-based
+  double m_np[5];       //!< Desired marker positions
+  double m_dn[5];       //!< Increments of the desired positions
+};
+
+/// p quantile of Student's t distribution with df degrees of freedom
+double StudentTQuantile (double p, uint64_t df);
+
+} // namespace ns3
+
+#endif /* VANETRC_RUNNING_STATS_H */
@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "sweep-runner.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <stdint.h>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+SweepRunner::SweepRunner (uint32_t workers)
+  : m_workers (workers)
+{
+  if (m_workers == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      m_workers = cores > 0 ? cores : 1;
+    }
+}
+
+uint32_t
+SweepRunner::GetWorkers (void) const
+{
+  return m_workers;
+}
+
+void
+SweepRunner::SetSkipCallback (SkipFunction skip)
+{
+  m_skip = skip;
+}
+
+void
+SweepRunner::SetResultCallback (ResultFunction result)
+{
+  m_result = result;
+}
+
+void
+SweepRunner::SetLogPattern (const std::string &pattern)
+{
+  m_logPattern = pattern;
+}
+
+std::string
+SweepRunner::LogPath (const SweepJob &job) const
+{
+  std::string path;
+  for (std::string::size_type i = 0; i < m_logPattern.size (); i++)
+    {
+      if (m_logPattern[i] == '%' && i + 1 < m_logPattern.size ())
+        {
+          char c = m_logPattern[++i];
+          if (c == 'c')
+            {
+              path += std::to_string (job.connections);
+              continue;
+            }
+          if (c == 's')
+            {
+              path += std::to_string (job.seed);
+              continue;
+            }
+          path += '%';
+        }
+      path += m_logPattern[i];
+    }
+  return path;
+}
+
+std::vector<uint32_t>
+SweepRunner::ParseList (const std::string &spec)
+{
+  std::vector<uint32_t> values;
+  std::stringstream items (spec);
+  std::string item;
+  while (std::getline (items, item, ','))
+    {
+      if (item.empty ())
+        {
+          continue;
+        }
+      // first[:last[:step]], each a plain decimal that fits in 32 bits
+      unsigned long field[3] = { 0, 0, 1 };
+      const char *p = item.c_str ();
+      int n = 0;
+      bool ok = true;
+      while (ok && n < 3)
+        {
+          char *end;
+          errno = 0;
+          field[n] = std::strtoul (p, &end, 10);
+          ok = end != p && *p >= '0' && *p <= '9' && errno == 0 && field[n] <= UINT32_MAX;
+          n++;
+          p = end;
+          if (!ok || *p != ':')
+            {
+              break;
+            }
+          p++;
+        }
+      if (n == 1)
+        {
+          field[1] = field[0];
+        }
+      if (!ok || *p != '\0' || field[2] == 0 || field[0] > field[1])
+        {
+          std::cerr << "Ignoring malformed sweep item '" << item << "'\n";
+          continue;
+        }
+      for (unsigned long v = field[0]; v <= field[1]; v += field[2])
+        {
+          values.push_back (v);
+          if (field[1] - v < field[2])
+            {
+              break;
+            }
+        }
+    }
+  return values;
+}
+
+std::vector<SweepJob>
+SweepRunner::MakeJobs (const std::vector<uint32_t> &connections,
+                       const std::vector<uint32_t> &seeds)
+{
+  std::vector<SweepJob> jobs;
+  for (uint32_t c = 0; c < connections.size (); c++)
+    {
+      for (uint32_t s = 0; s < seeds.size (); s++)
+        {
+          SweepJob job;
+          job.connections = connections[c];
+          job.seed = seeds[s];
+          jobs.push_back (job);
+        }
+    }
+  return jobs;
+}
+
+bool
+SweepRunner::Run (const std::vector<SweepJob> &jobs, JobFunction fn,
+                  std::vector<RunResult> &results, std::vector<bool> &done)
+{
+  results.assign (jobs.size (), RunResult ());
+  done.assign (jobs.size (), false);
+
+  // Flush before forking so buffered parent output is not duplicated
+  std::cout.flush ();
+  std::fflush (NULL);
+
+  // pid -> (job index, read end of the job's pipe)
+  std::map<pid_t, std::pair<uint32_t, int> > running;
+  uint32_t next = 0;
+  bool ok = true;
+
+  while (next < jobs.size () || !running.empty ())
+    {
+      while (next < jobs.size () && running.size () < m_workers)
+        {
+          if (m_skip && m_skip (next))
+            {
+              next++;
+              continue;
+            }
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              std::perror ("pipe");
+              return false;
+            }
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              std::perror ("fork");
+              close (fds[0]);
+              close (fds[1]);
+              return false;
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              std::string log = LogPath (jobs[next]);
+              int out = open (log.empty () ? "/dev/null" : log.c_str (),
+                              O_WRONLY | O_CREAT | O_TRUNC, 0644);
+              if (out >= 0)
+                {
+                  dup2 (out, STDOUT_FILENO);
+                  close (out);
+                }
+              RunResult r = fn (jobs[next]);
+              std::cout.flush ();
+              // A RunResult is far below PIPE_BUF, so this write is atomic
+              ssize_t n = write (fds[1], &r, sizeof (r));
+              close (fds[1]);
+              _exit (n == sizeof (r) ? 0 : 1);
+            }
+          close (fds[1]);
+          running[pid] = std::make_pair (next, fds[0]);
+          next++;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          std::perror ("waitpid");
+          return false;
+        }
+      std::map<pid_t, std::pair<uint32_t, int> >::iterator it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      uint32_t index = it->second.first;
+      int fd = it->second.second;
+      running.erase (it);
+
+      RunResult r;
+      ssize_t n = read (fd, &r, sizeof (r));
+      close (fd);
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0 && n == sizeof (r))
+        {
+          results[index] = r;
+          done[index] = true;
+        }
+      else
+        {
+          ok = false;
+          std::cerr << "Replication connections=" << jobs[index].connections
+                    << " seed=" << jobs[index].seed << " failed\n";
+        }
+      if (m_result)
+        {
+          m_result (index, done[index], results[index]);
+        }
+    }
+  return ok;
+}
+
+} // namespace ns3
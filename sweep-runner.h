@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_SWEEP_RUNNER_H
+#define VANETRC_SWEEP_RUNNER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "run-result.h"
+
+namespace ns3 {
+
+/**
+ * One replication of a sweep: a (connections, seed) point.
+ */
+struct SweepJob
+{
+  uint32_t connections;
+  uint32_t seed;
+};
+
+/**
+ * Runs independent replications on a pool of forked worker processes.
+ *
+ * The ns-3 simulator is a process-wide singleton, so each replication gets
+ * its own process. Every worker sends back one RunResult through its own
+ * pipe; only the parent touches the report, which is why rows can neither
+ * interleave nor get lost. Results are returned in job order, independent
+ * of the order in which the workers finish.
+ */
+class SweepRunner
+{
+public:
+  typedef std::function<RunResult (const SweepJob &)> JobFunction;
+  /// Asked before a job is started, in the parent; true skips the job
+  typedef std::function<bool (uint32_t job)> SkipFunction;
+  /// Called in the parent as each job ends, in completion order
+  typedef std::function<void (uint32_t job, bool ok, const RunResult &result)> ResultFunction;
+
+  /**
+   * \param workers maximum number of concurrent worker processes,
+   *        0 uses one per online core
+   */
+  SweepRunner (uint32_t workers);
+
+  /**
+   * Run every job, at most GetWorkers () at a time.
+   *
+   * \param jobs the replications to run
+   * \param fn called in the worker process for its job
+   * \param results one entry per job, in job order
+   * \param done set to false for the jobs whose worker failed or that
+   *        were skipped
+   * \return true if all the workers succeeded
+   */
+  bool Run (const std::vector<SweepJob> &jobs, JobFunction fn,
+            std::vector<RunResult> &results, std::vector<bool> &done);
+
+  uint32_t GetWorkers (void) const;
+
+  /**
+   * Where a worker's stdout goes; "%c" and "%s" are replaced with the
+   * job's connections and seed. Empty discards the output.
+   */
+  void SetLogPattern (const std::string &pattern);
+
+  /**
+   * Let the results of finished jobs decide which of the remaining jobs
+   * still run, e.g. to stop replicating once a metric is precise enough.
+   */
+  void SetSkipCallback (SkipFunction skip);
+  void SetResultCallback (ResultFunction result);
+
+  /**
+   * Parse "1:100", "1:100:5" or "5,10,15,20" (and mixes such as "1:3,7")
+   * into a list of values. An item that is not made of unsigned 32-bit
+   * decimals, has a zero step or a first value above the last is reported
+   * on stderr and skipped.
+   */
+  static std::vector<uint32_t> ParseList (const std::string &spec);
+
+  /**
+   * Cross product of the connection counts and seeds, connections major.
+   */
+  static std::vector<SweepJob> MakeJobs (const std::vector<uint32_t> &connections,
+                                         const std::vector<uint32_t> &seeds);
+
+private:
+  std::string LogPath (const SweepJob &job) const;
+
+  uint32_t m_workers;
+  std::string m_logPattern;
+  SkipFunction m_skip;
+  ResultFunction m_result;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_SWEEP_RUNNER_H */
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "throughput-sampler.h"
+
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ThroughputSampler");
+
+ThroughputSampler::ThroughputSampler (Ptr<const FlowStatsCollector> flows, uint32_t nodes,
+                                      uint32_t blockSamples)
+  : m_flows (flows),
+    m_nodes (nodes),
+    m_blockSamples (blockSamples),
+    m_columns (flows->GetN () + nodes),
+    m_file (0),
+    m_last (flows->GetN (), 0),
+    m_rows (blockSamples * m_columns, 0),
+    m_times (blockSamples, 0),
+    m_count (0),
+    m_block (blockSamples * m_columns, 0)
+{
+  NS_ASSERT (blockSamples > 0);
+}
+
+ThroughputSampler::~ThroughputSampler ()
+{
+  if (m_file)
+    {
+      std::fclose (m_file);
+    }
+}
+
+bool
+ThroughputSampler::Start (const std::string &path, Time interval)
+{
+  NS_LOG_FUNCTION (this << path << interval);
+  NS_ASSERT (interval.IsStrictlyPositive () && m_file == 0);
+  m_file = std::fopen (path.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_LOG_ERROR ("Cannot open " << path);
+      return false;
+    }
+  ThroughputFileHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, THROUGHPUT_MAGIC, sizeof (THROUGHPUT_MAGIC));
+  header.version = THROUGHPUT_VERSION;
+  header.flows = m_flows->GetN ();
+  header.nodes = m_nodes;
+  header.blockSamples = m_blockSamples;
+  header.interval = interval.GetSeconds ();
+  std::fwrite (&header, sizeof (header), 1, m_file);
+
+  for (uint32_t f = 0; f < m_flows->GetN (); f++)
+    {
+      m_last[f] = m_flows->Get (f).rxBytes;
+    }
+  m_interval = interval;
+  m_event = Simulator::Schedule (m_interval, &ThroughputSampler::Tick, this);
+  return true;
+}
+
+void
+ThroughputSampler::Stop (void)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  Sample ();
+  Flush ();
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+void
+ThroughputSampler::Sample (void)
+{
+  uint32_t *row = &m_rows[m_count * m_columns];
+  uint32_t *nodeBytes = row + m_flows->GetN ();
+  std::memset (nodeBytes, 0, m_nodes * sizeof (uint32_t));
+  for (uint32_t f = 0; f < m_flows->GetN (); f++)
+    {
+      uint64_t rx = m_flows->Get (f).rxBytes;
+      row[f] = rx - m_last[f];
+      nodeBytes[m_flows->GetFlow (f).sink] += row[f];
+      m_last[f] = rx;
+    }
+  m_times[m_count] = Simulator::Now ().GetSeconds ();
+  if (++m_count == m_blockSamples)
+    {
+      Flush ();
+    }
+}
+
+void
+ThroughputSampler::Tick (void)
+{
+  Sample ();
+  m_event = Simulator::Schedule (m_interval, &ThroughputSampler::Tick, this);
+}
+
+void
+ThroughputSampler::Flush (void)
+{
+  if (m_count == 0)
+    {
+      return;
+    }
+  for (uint32_t s = 0; s < m_count; s++)
+    {
+      for (uint32_t c = 0; c < m_columns; c++)
+        {
+          m_block[c * m_count + s] = m_rows[s * m_columns + c];
+        }
+    }
+  uint32_t size[2] = { m_count, 0 };
+  std::fwrite (size, sizeof (size), 1, m_file);
+  std::fwrite (m_times.data (), sizeof (double), m_count, m_file);
+  std::fwrite (m_block.data (), sizeof (uint32_t), m_count * m_columns, m_file);
+  m_count = 0;
+}
+
+} // namespace ns3
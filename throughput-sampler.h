@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_THROUGHPUT_SAMPLER_H
+#define VANETRC_THROUGHPUT_SAMPLER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "flow-stats-collector.h"
+
+/*
+ * Throughput time series, host byte order:
+ *
+ *   ThroughputFileHeader
+ *   blocks until the end of the file, each
+ *     uint32_t samples, uint32_t reserved
+ *     double time[samples]                      s, end of the interval
+ *     uint32_t flowBytes[flows][samples]        rx bytes in the interval
+ *     uint32_t nodeBytes[nodes][samples]        rx bytes of the flows to the node
+ *
+ * A flow's or node's column is contiguous within a block.
+ */
+
+#define THROUGHPUT_MAGIC "VRCTPS1"
+#define THROUGHPUT_VERSION 1
+
+namespace ns3 {
+
+struct ThroughputFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t flows;
+  uint32_t nodes;
+  uint32_t blockSamples;   //!< Samples of a full block
+  double interval;         //!< s
+};
+
+/**
+ * Samples the rx bytes of every data flow and every node at a fixed
+ * interval.
+ *
+ * One event per interval reads the FlowStatsCollector counters, so the
+ * cost is one pass over the flows whatever their number. Samples go to a
+ * preallocated buffer of blockSamples rows, which is written out column by
+ * column whenever it fills up and at Stop ().
+ */
+class ThroughputSampler : public SimpleRefCount<ThroughputSampler>
+{
+public:
+  ThroughputSampler (Ptr<const FlowStatsCollector> flows, uint32_t nodes,
+                     uint32_t blockSamples = 256);
+  ~ThroughputSampler ();
+
+  /**
+   * Open path and sample every interval from now on.
+   *
+   * \return false if path cannot be written
+   */
+  bool Start (const std::string &path, Time interval);
+  /// Take a last sample, write the buffered ones and close the file
+  void Stop (void);
+
+private:
+  void Tick (void);
+  void Sample (void);
+  void Flush (void);
+
+  Ptr<const FlowStatsCollector> m_flows;
+  uint32_t m_nodes;
+  uint32_t m_blockSamples;
+  uint32_t m_columns;
+  Time m_interval;
+  EventId m_event;
+  std::FILE *m_file;
+  /// Cumulative rx bytes of each flow at the previous sample
+  std::vector<uint64_t> m_last;
+  /// Buffered samples, one row of m_columns values per sample
+  std::vector<uint32_t> m_rows;
+  std::vector<double> m_times;
+  uint32_t m_count;
+  /// Column-major copy of a block, reused by Flush ()
+  std::vector<uint32_t> m_block;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_THROUGHPUT_SAMPLER_H */
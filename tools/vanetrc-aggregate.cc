@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Aggregates results stores (see results-store.h) in one streaming pass:
+ * per (routing, connections, size, rate) key and metric column, the number of
+ * replications, mean, standard deviation, confidence interval of the mean
+ * and the 10th, 50th and 90th percentiles (exact up to 512 replications,
+ * P² estimates beyond, see running-stats.h). Memory only grows with the
+ * number of keys, not rows.
+ *
+ * Columns are found by name in the store's column line, so stores of a
+ * later schema version with more columns are read as well. A file without
+ * the schema line is read as the old report, "connections,seed,pdf,
+ * rxbitrate" rows with routing "-", size 0 and rate 0.
+ *
+ *   g++ -O2 -std=c++11 -o vanetrc-aggregate vanetrc-aggregate.cc ../running-stats.cc
+ *   ./vanetrc-aggregate [-l level, default 0.95] results.csv... > summary.csv
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "../results-store.h"
+#include "../running-stats.h"
+
+using ns3::RunningStats;
+using ns3::P2Quantile;
+
+struct Key
+{
+  std::string routing;
+  uint32_t connections;
+  uint32_t size;
+  uint64_t rate;
+
+  bool operator< (const Key &o) const
+  {
+    if (routing != o.routing)
+      {
+        return routing < o.routing;
+      }
+    if (size != o.size)
+      {
+        return size < o.size;
+      }
+    if (rate != o.rate)
+      {
+        return rate < o.rate;
+      }
+    return connections < o.connections;
+  }
+};
+
+struct Metric
+{
+  Metric ()
+    : p10 (0.1),
+      p50 (0.5),
+      p90 (0.9)
+  {
+  }
+
+  RunningStats stats;
+  P2Quantile p10;
+  P2Quantile p50;
+  P2Quantile p90;
+};
+
+static std::vector<std::string> g_metrics;            // metric names, output order
+static std::map<std::string, uint32_t> g_metricIndex;
+static std::map<Key, std::vector<Metric> > g_groups;
+
+static void
+Split (char *line, std::vector<char *> &fields)
+{
+  fields.clear ();
+  char *p = line;
+  for (;;)
+    {
+      fields.push_back (p);
+      char *comma = std::strchr (p, ',');
+      if (comma == 0)
+        {
+          break;
+        }
+      *comma = '\0';
+      p = comma + 1;
+    }
+}
+
+/// Role of each column of a file: key column or metric index
+struct Columns
+{
+  int routing;
+  int connections;
+  int size;
+  int rate;
+  std::vector<int> metric;          // -1 for key and ignored columns
+  std::string header;               // the column line, to skip repeats
+};
+
+static void
+SetColumns (const char *line, Columns &columns)
+{
+  std::vector<char> copy (line, line + std::strlen (line) + 1);
+  std::vector<char *> names;
+  Split (copy.data (), names);
+  columns.routing = columns.connections = columns.size = columns.rate = -1;
+  columns.metric.assign (names.size (), -1);
+  columns.header = line;
+  for (uint32_t i = 0; i < names.size (); i++)
+    {
+      std::string name = names[i];
+      if (name == "routing")
+        {
+          columns.routing = i;
+        }
+      else if (name == "connections")
+        {
+          columns.connections = i;
+        }
+      else if (name == "size")
+        {
+          columns.size = i;
+        }
+      else if (name == "rate")
+        {
+          columns.rate = i;
+        }
+      else if (name != "seed")
+        {
+          std::map<std::string, uint32_t>::iterator m = g_metricIndex.find (name);
+          if (m == g_metricIndex.end ())
+            {
+              m = g_metricIndex.insert (std::make_pair (name, (uint32_t) g_metrics.size ())).first;
+              g_metrics.push_back (name);
+            }
+          columns.metric[i] = m->second;
+        }
+    }
+}
+
+static void
+AddRow (char *line, const Columns &columns, std::vector<char *> &fields)
+{
+  Split (line, fields);
+  if (fields.size () != columns.metric.size ())
+    {
+      return;
+    }
+  Key key;
+  key.routing = columns.routing >= 0 ? fields[columns.routing] : "-";
+  key.connections = columns.connections >= 0 ? std::strtoul (fields[columns.connections], 0, 10) : 0;
+  key.size = columns.size >= 0 ? std::strtoul (fields[columns.size], 0, 10) : 0;
+  key.rate = columns.rate >= 0 ? std::strtoull (fields[columns.rate], 0, 10) : 0;
+  std::vector<Metric> &metrics = g_groups[key];
+  if (metrics.size () < g_metrics.size ())
+    {
+      metrics.resize (g_metrics.size ());
+    }
+  for (uint32_t i = 0; i < fields.size (); i++)
+    {
+      if (columns.metric[i] < 0)
+        {
+          continue;
+        }
+      double x = std::strtod (fields[i], 0);
+      Metric &m = metrics[columns.metric[i]];
+      m.stats.Add (x);
+      m.p10.Add (x);
+      m.p50.Add (x);
+      m.p90.Add (x);
+    }
+}
+
+static bool
+ReadFile (const char *path)
+{
+  std::FILE *f = std::fopen (path, "r");
+  if (f == 0)
+    {
+      std::perror (path);
+      return false;
+    }
+  static char buffer[1 << 20];
+  std::setvbuf (f, buffer, _IOFBF, sizeof (buffer));
+  Columns columns;
+  std::vector<char *> fields;
+  char line[4096];
+  bool first = true, expectColumns = false;
+  while (std::fgets (line, sizeof (line), f))
+    {
+      size_t n = std::strlen (line);
+      while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r'))
+        {
+          line[--n] = '\0';
+        }
+      if (first)
+        {
+          first = false;
+          // Any version: later ones only add columns
+          if (std::strncmp (line, RESULTS_SCHEMA, std::strlen (RESULTS_SCHEMA) - 1) == 0)
+            {
+              expectColumns = true;
+              continue;
+            }
+          SetColumns ("connections,seed,pdf,rxbitrate", columns);
+        }
+      if (expectColumns)
+        {
+          expectColumns = false;
+          SetColumns (line, columns);
+          continue;
+        }
+      if (n == 0 || line[0] == '#' || columns.header == line)
+        {
+          continue;
+        }
+      AddRow (line, columns, fields);
+    }
+  std::fclose (f);
+  return true;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double level = 0.95;
+  int arg = 1;
+  if (arg + 1 < argc && std::strcmp (argv[arg], "-l") == 0)
+    {
+      level = std::atof (argv[arg + 1]);
+      arg += 2;
+    }
+  if (arg >= argc || level <= 0 || level >= 1)
+    {
+      std::fprintf (stderr, "usage: %s [-l level] results.csv...\n", argv[0]);
+      return 1;
+    }
+  for (; arg < argc; arg++)
+    {
+      if (!ReadFile (argv[arg]))
+        {
+          return 1;
+        }
+    }
+
+  std::printf ("routing,connections,size,rate,metric,n,mean,stddev,ci_low,ci_high,p10,p50,p90\n");
+  for (std::map<Key, std::vector<Metric> >::const_iterator g = g_groups.begin (); g != g_groups.end (); ++g)
+    {
+      for (uint32_t i = 0; i < g->second.size (); i++)
+        {
+          const Metric &m = g->second[i];
+          if (m.stats.GetCount () == 0)
+            {
+              continue;
+            }
+          double mean = m.stats.GetMean (), half = m.stats.GetHalfWidth (level);
+          std::printf ("%s,%u,%u,%llu,%s,%llu,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n",
+                       g->first.routing.c_str (), g->first.connections, g->first.size,
+                       (unsigned long long) g->first.rate,
+                       g_metrics[i].c_str (), (unsigned long long) m.stats.GetCount (),
+                       mean, m.stats.GetStddev (), mean - half, mean + half,
+                       m.p10.Get (), m.p50.Get (), m.p90.Get ());
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Formats the event logs written by every VanetRC replication (see
+ * event-log-format.h), one line per event in time order; with a type
+ * name (flow-setup, app-start, flow-result, total, ...), only the events
+ * of that type.
+ *
+ *   g++ -O2 -std=c++11 -o vanetrc-events vanetrc-events.cc
+ *   ./vanetrc-events events.bin [type]
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "../event-log-format.h"
+
+static const char *g_names[EVENT_TYPES] = {
+  "warm-start", "flow-setup", "app-start", "app-stop", "quiescent",
+  "sink", "flow-result", "routing-load", "total", "route-found",
+  "route-dump", "route-diff"
+};
+
+static void
+Print (const EventRecord &r)
+{
+  std::printf ("%10.6f  %-12s  ", r.time, g_names[r.type]);
+  switch (r.type)
+    {
+    case EVENT_FLOW_SETUP:
+      std::printf ("flow %u: node %u to node %u, %g s to %g s\n", r.a + 1, r.b, r.c, r.value[0], r.value[1]);
+      break;
+    case EVENT_APP_START:
+    case EVENT_APP_STOP:
+      std::printf ("flow %u at node %u\n", r.a + 1, r.b);
+      break;
+    case EVENT_SINK:
+      std::printf ("node %u: %.0f bytes received\n", r.a, r.value[0]);
+      break;
+    case EVENT_FLOW_RESULT:
+      std::printf ("flow %u (node %u -> node %u): PDF %g %%, delay %g s, rx %g kbps, tx %g kbps\n",
+                   r.a + 1, r.b, r.c, r.value[0], r.value[1], r.value[2], r.value[3]);
+      break;
+    case EVENT_ROUTING_LOAD:
+      std::printf ("RL tx packets %g, rx packets %g, tx bytes %g, rx bytes %g (%u RREQs suppressed)\n",
+                   r.value[0], r.value[1], r.value[2], r.value[3], r.a);
+      break;
+    case EVENT_TOTAL:
+      std::printf ("%u connections: PDF %g %%, rx %g kbps, delay %g s\n", r.a, r.value[0], r.value[1], r.value[2]);
+      break;
+    case EVENT_ROUTE_FOUND:
+      std::printf ("flow %u (node %u -> node %u): first delivery %g s after the first send\n",
+                   r.a + 1, r.b, r.c, r.value[0]);
+      break;
+    case EVENT_ROUTE_DUMP:
+      std::printf ("routing tables dumped to routing_table%u\n", r.a);
+      break;
+    case EVENT_ROUTE_DIFF:
+      std::printf ("%s: %u routes added, %u changed, %u removed\n",
+                   r.value[0] != 0 ? "snapshot" : "diff", r.a, r.b, r.c);
+      break;
+    default:
+      std::printf ("\n");
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc < 2 || argc > 3)
+    {
+      std::fprintf (stderr, "usage: %s events.bin [type]\n", argv[0]);
+      return 1;
+    }
+  int only = -1;
+  if (argc == 3)
+    {
+      for (int t = 0; t < EVENT_TYPES; t++)
+        {
+          if (std::strcmp (argv[2], g_names[t]) == 0)
+            {
+              only = t;
+            }
+        }
+      if (only < 0)
+        {
+          std::fprintf (stderr, "%s: unknown event type\n", argv[2]);
+          return 1;
+        }
+    }
+  std::FILE *f = std::fopen (argv[1], "rb");
+  if (f == 0)
+    {
+      std::perror (argv[1]);
+      return 1;
+    }
+  EventLogHeader header;
+  if (std::fread (&header, sizeof (header), 1, f) != 1
+      || std::memcmp (header.magic, EVENT_LOG_MAGIC, sizeof (EVENT_LOG_MAGIC)) != 0
+      || header.version != EVENT_LOG_VERSION)
+    {
+      std::fprintf (stderr, "%s: not an event log\n", argv[1]);
+      return 1;
+    }
+  std::vector<EventRecord> records (header.records);
+  if (std::fread (records.data (), sizeof (EventRecord), header.records, f) != header.records)
+    {
+      std::fprintf (stderr, "%s: truncated, %u records expected\n", argv[1], header.records);
+      return 1;
+    }
+  std::fclose (f);
+
+  std::printf ("# %s, %u nodes, %u connections, seed %u, %u byte packets\n",
+               header.routing, header.size, header.connections, header.seed, header.packetSize);
+  for (std::vector<EventRecord>::const_iterator r = records.begin (); r != records.end (); ++r)
+    {
+      if (r->type < EVENT_TYPES && (only < 0 || (int) r->type == only))
+        {
+          Print (*r);
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Reads the routing snapshots written by VanetRC --route-interval (see
+ * routing-snapshot-format.h).
+ *
+ * Without a time, prints the route churn of every block: time, routes
+ * added, changed and removed. With a time, rebuilds and prints the tables
+ * at that time, of every node or of one node.
+ *
+ *   g++ -O2 -std=c++11 -o vanetrc-routes vanetrc-routes.cc
+ *   ./vanetrc-routes routes.bin [time [node]]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "../routing-snapshot-format.h"
+
+static void
+PrintAddress (uint32_t a)
+{
+  std::printf ("%u.%u.%u.%u", a >> 24, (a >> 16) & 0xff, (a >> 8) & 0xff, a & 0xff);
+}
+
+static const char *
+StateName (uint8_t state)
+{
+  switch (state)
+    {
+    case ROUTE_INVALID:
+      return "DOWN";
+    case ROUTE_IN_SEARCH:
+      return "IN_SEARCH";
+    default:
+      return "UP";
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc < 2 || argc > 4)
+    {
+      std::fprintf (stderr, "usage: %s routes.bin [time [node]]\n", argv[0]);
+      return 1;
+    }
+  std::FILE *f = std::fopen (argv[1], "rb");
+  if (f == 0)
+    {
+      std::perror (argv[1]);
+      return 1;
+    }
+  RoutingSnapshotHeader header;
+  if (std::fread (&header, sizeof (header), 1, f) != 1
+      || std::memcmp (header.magic, ROUTING_SNAPSHOT_MAGIC, sizeof (ROUTING_SNAPSHOT_MAGIC)) != 0
+      || header.version != ROUTING_SNAPSHOT_VERSION)
+    {
+      std::fprintf (stderr, "%s: not a routing snapshot file\n", argv[1]);
+      return 1;
+    }
+  bool churn = argc == 2;
+  double until = churn ? 0 : std::atof (argv[2]);
+  long only = argc == 4 ? std::atol (argv[3]) : -1;
+
+  // node -> destination -> route
+  std::vector<std::map<uint32_t, RouteRecord> > tables (header.nodes);
+  std::vector<RouteRecord> records;
+  RoutingBlockHeader block;
+  if (churn)
+    {
+      std::printf ("# %s, %u nodes\n# time\tadded\tchanged\tremoved\n", header.protocol, header.nodes);
+    }
+  while (std::fread (&block, sizeof (block), 1, f) == 1)
+    {
+      if (!churn && block.time > until)
+        {
+          break;
+        }
+      records.resize (block.records);
+      if (std::fread (records.data (), sizeof (RouteRecord), block.records, f) != block.records)
+        {
+          std::fprintf (stderr, "%s: truncated block at %g s\n", argv[1], block.time);
+          return 1;
+        }
+      uint32_t count[3] = { 0, 0, 0 };
+      for (std::vector<RouteRecord>::const_iterator r = records.begin (); r != records.end (); ++r)
+        {
+          if (r->op > ROUTE_REMOVE || r->node >= header.nodes)
+            {
+              continue;
+            }
+          count[r->op]++;
+          if (r->op == ROUTE_REMOVE)
+            {
+              tables[r->node].erase (r->destination);
+            }
+          else
+            {
+              tables[r->node][r->destination] = *r;
+            }
+        }
+      if (churn)
+        {
+          std::printf ("%g\t%u\t%u\t%u\n", block.time, count[ROUTE_ADD], count[ROUTE_CHANGE], count[ROUTE_REMOVE]);
+        }
+    }
+  std::fclose (f);
+  if (churn)
+    {
+      return 0;
+    }
+
+  for (uint32_t n = 0; n < header.nodes; n++)
+    {
+      if (only >= 0 && n != (uint32_t) only)
+        {
+          continue;
+        }
+      std::printf ("Node %u, %s routing table at %g s\nDestination\tGateway\t\tHops\tFlag\n", n, header.protocol, until);
+      for (std::map<uint32_t, RouteRecord>::const_iterator i = tables[n].begin (); i != tables[n].end (); ++i)
+        {
+          PrintAddress (i->second.destination);
+          std::printf ("\t");
+          PrintAddress (i->second.gateway);
+          std::printf ("\t%u\t%s\n", i->second.hops, StateName (i->second.state));
+        }
+      std::printf ("\n");
+    }
+  return 0;
+}
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Converts a text vehicle trace into the binary format replayed by
+ * VanetRC --trace-file (see vehicle-trace-format.h).
+ *
+ * Input: one "time id x y speed" sample per line, sorted by time; blank
+ * lines and lines starting with '#' are skipped. The input is streamed, so
+ * memory only grows with the number of vehicles and windows.
+ *
+ *   g++ -O2 -std=c++11 -o vanetrc-trace-convert vanetrc-trace-convert.cc
+ *   ./vanetrc-trace-convert trace.txt trace.bin [window seconds, default 10]
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../vehicle-trace-format.h"
+
+static int g_fd;
+static std::vector<VehicleTraceRecord> g_buffer;
+static uint64_t g_flushed = 0;     // records already written
+
+static bool
+WriteAt (const void *data, size_t length, uint64_t offset)
+{
+  const char *p = static_cast<const char *> (data);
+  while (length > 0)
+    {
+      ssize_t n = pwrite (g_fd, p, length, offset);
+      if (n <= 0)
+        {
+          std::perror ("pwrite");
+          return false;
+        }
+      p += n;
+      length -= n;
+      offset += n;
+    }
+  return true;
+}
+
+static bool
+Flush (void)
+{
+  uint64_t offset = sizeof (VehicleTraceHeader) + g_flushed * sizeof (VehicleTraceRecord);
+  if (!WriteAt (g_buffer.data (), g_buffer.size () * sizeof (VehicleTraceRecord), offset))
+    {
+      return false;
+    }
+  g_flushed += g_buffer.size ();
+  g_buffer.clear ();
+  return true;
+}
+
+/// Set the next link of record r, wherever it currently is
+static bool
+Link (uint64_t r, uint64_t next)
+{
+  uint32_t link = next - r;
+  if (r >= g_flushed)
+    {
+      g_buffer[r - g_flushed].next = link;
+      return true;
+    }
+  uint64_t offset = sizeof (VehicleTraceHeader) + r * sizeof (VehicleTraceRecord)
+    + offsetof (VehicleTraceRecord, next);
+  return WriteAt (&link, sizeof (link), offset);
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc < 3)
+    {
+      std::fprintf (stderr, "usage: %s input.txt output.bin [window seconds]\n", argv[0]);
+      return 2;
+    }
+  double windowSeconds = argc > 3 ? std::atof (argv[3]) : 10.0;
+  if (windowSeconds <= 0)
+    {
+      std::fprintf (stderr, "window must be positive\n");
+      return 2;
+    }
+  FILE *in = std::fopen (argv[1], "r");
+  if (!in)
+    {
+      std::perror (argv[1]);
+      return 1;
+    }
+  g_fd = open (argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (g_fd < 0)
+    {
+      std::perror (argv[2]);
+      return 1;
+    }
+
+  VehicleTraceHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, VEHICLE_TRACE_MAGIC, 8);
+  header.version = VEHICLE_TRACE_VERSION;
+  header.windowSeconds = windowSeconds;
+
+  std::vector<uint64_t> windowIndex;
+  std::vector<uint64_t> firstRecord;
+  std::vector<uint64_t> lastRecord;
+  const size_t chunk = 1 << 16;
+  g_buffer.reserve (chunk);
+
+  char line[512];
+  uint64_t lineNumber = 0;
+  uint64_t records = 0;
+  double lastTime = -INFINITY;
+  while (std::fgets (line, sizeof (line), in))
+    {
+      lineNumber++;
+      double t, x, y, speed;
+      unsigned long id;
+      if (line[0] == '#' || std::sscanf (line, "%lf %lu %lf %lf %lf", &t, &id, &x, &y, &speed) != 5)
+        {
+          continue;
+        }
+      if (t < lastTime)
+        {
+          std::fprintf (stderr, "line %llu: samples must be sorted by time\n", (unsigned long long) lineNumber);
+          return 1;
+        }
+      if (records == 0)
+        {
+          header.startTime = t;
+        }
+      lastTime = t;
+
+      uint64_t window = std::floor ((t - header.startTime) / windowSeconds);
+      while (windowIndex.size () <= window)
+        {
+          windowIndex.push_back (records);
+        }
+      if (id >= firstRecord.size ())
+        {
+          firstRecord.resize (id + 1, VEHICLE_TRACE_NONE);
+          lastRecord.resize (id + 1, VEHICLE_TRACE_NONE);
+        }
+      if (firstRecord[id] == VEHICLE_TRACE_NONE)
+        {
+          firstRecord[id] = records;
+        }
+      else if (records - lastRecord[id] > UINT32_MAX)
+        {
+          // A link is 32 bits; a zero would silently end the vehicle's chain
+          std::fprintf (stderr, "line %llu: vehicle %lu has no sample in the %llu records before, more than a link spans\n",
+                        (unsigned long long) lineNumber, id, (unsigned long long) (records - lastRecord[id]));
+          return 1;
+        }
+      else if (!Link (lastRecord[id], records))
+        {
+          return 1;
+        }
+      lastRecord[id] = records;
+
+      VehicleTraceRecord record;
+      std::memset (&record, 0, sizeof (record));
+      record.time = t;
+      record.id = id;
+      record.x = x;
+      record.y = y;
+      record.speed = speed;
+      if (speed > header.maxSpeed)
+        {
+          header.maxSpeed = speed;
+        }
+      g_buffer.push_back (record);
+      records++;
+      if (g_buffer.size () == chunk && !Flush ())
+        {
+          return 1;
+        }
+    }
+  std::fclose (in);
+  if (!Flush ())
+    {
+      return 1;
+    }
+
+  header.records = records;
+  header.vehicles = firstRecord.size ();
+  header.windows = windowIndex.size ();
+  windowIndex.push_back (records);
+  uint64_t offset = sizeof (header) + records * sizeof (VehicleTraceRecord);
+  if (!WriteAt (windowIndex.data (), windowIndex.size () * sizeof (uint64_t), offset)
+      || !WriteAt (firstRecord.data (), firstRecord.size () * sizeof (uint64_t),
+                   offset + windowIndex.size () * sizeof (uint64_t))
+      || !WriteAt (&header, sizeof (header), 0))
+    {
+      return 1;
+    }
+  close (g_fd);
+  std::printf ("%llu samples of %u vehicles in %llu windows of %g s\n",
+               (unsigned long long) records, header.vehicles,
+               (unsigned long long) header.windows, windowSeconds);
+  return 0;
+}
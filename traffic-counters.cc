@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "traffic-counters.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "flow-stats-collector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TrafficCounters");
+
+TrafficCounters::TrafficCounters (bool trackInFlight)
+  : m_dataLost (0),
+    m_trackInFlight (trackInFlight)
+{
+  for (int c = 0; c < 2; c++)
+    {
+      m_txPackets[c] = m_txBytes[c] = m_rxPackets[c] = m_rxBytes[c] = 0;
+    }
+}
+
+void
+TrafficCounters::Install (const NodeContainer &nodes)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<Ipv4L3Protocol> ipv4 = (*i)->GetObject<Ipv4L3Protocol> ();
+      NS_ABORT_MSG_IF (ipv4 == 0, "Node " << (*i)->GetId () << " has no internet stack");
+      uint32_t id = (*i)->GetId ();
+      ipv4->TraceConnectWithoutContext ("SendOutgoing", MakeBoundCallback (&TrafficCounters::SendOutgoing, this, id));
+      ipv4->TraceConnectWithoutContext ("LocalDeliver", MakeBoundCallback (&TrafficCounters::LocalDeliver, this, id));
+      if (m_trackInFlight)
+        {
+          ipv4->TraceConnectWithoutContext ("UnicastForward", MakeCallback (&TrafficCounters::UnicastForward, this));
+          ipv4->TraceConnectWithoutContext ("Drop", MakeCallback (&TrafficCounters::Drop, this));
+        }
+    }
+}
+
+void
+TrafficCounters::SetFlows (const FlowTable &flows)
+{
+  m_flows.clear ();
+  for (uint32_t i = 0; i < flows.GetN (); i++)
+    {
+      m_flows.push_back (flows.Get (i));
+    }
+}
+
+int64_t
+TrafficCounters::DataFlow (Ptr<const Packet> packet) const
+{
+  FlowStampTag stamp;
+  if (!packet->FindFirstMatchingByteTag (stamp))
+    {
+      return -1;
+    }
+  // A stamp of an unknown flow is still data, counted wherever it is seen
+  return stamp.GetFlow () < m_flows.size () ? stamp.GetFlow () : m_flows.size ();
+}
+
+void
+TrafficCounters::Progress (Ptr<const Packet> packet)
+{
+  std::unordered_map<uint64_t, int64_t>::iterator i = m_inFlight.find (packet->GetUid ());
+  if (i != m_inFlight.end ())
+    {
+      i->second = Simulator::Now ().GetTimeStep ();
+    }
+}
+
+void
+TrafficCounters::SendOutgoing (TrafficCounters *counters, uint32_t node, const Ipv4Header &header,
+                               Ptr<const Packet> packet, uint32_t interface)
+{
+  int64_t flow = counters->DataFlow (packet);
+  if (flow >= 0 && flow < (int64_t) counters->m_flows.size () && node != counters->m_flows[flow].source)
+    {
+      counters->Progress (packet);
+      return;
+    }
+  int c = flow >= 0 ? DATA : CONTROL;
+  counters->m_txPackets[c]++;
+  counters->m_txBytes[c] += packet->GetSize () + header.GetSerializedSize ();
+  if (c == DATA && counters->m_trackInFlight)
+    {
+      counters->m_inFlight[packet->GetUid ()] = Simulator::Now ().GetTimeStep ();
+    }
+}
+
+void
+TrafficCounters::UnicastForward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  Progress (packet);
+}
+
+void
+TrafficCounters::LocalDeliver (TrafficCounters *counters, uint32_t node, const Ipv4Header &header,
+                               Ptr<const Packet> packet, uint32_t interface)
+{
+  int64_t flow = counters->DataFlow (packet);
+  if (flow >= 0 && flow < (int64_t) counters->m_flows.size () && node != counters->m_flows[flow].sink)
+    {
+      counters->Progress (packet);
+      return;
+    }
+  int c = flow >= 0 ? DATA : CONTROL;
+  counters->m_rxPackets[c]++;
+  counters->m_rxBytes[c] += packet->GetSize () + header.GetSerializedSize ();
+  if (c == DATA)
+    {
+      counters->m_inFlight.erase (packet->GetUid ());
+    }
+}
+
+void
+TrafficCounters::Drop (const Ipv4Header &header, Ptr<const Packet> packet,
+                       Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (m_inFlight.erase (packet->GetUid ()) > 0)
+    {
+      NS_LOG_LOGIC ("Data packet " << packet->GetUid () << " dropped, reason " << reason);
+      m_dataLost++;
+    }
+}
+
+uint64_t
+TrafficCounters::ExpireDataInFlight (Time maxPerHopDelay)
+{
+  NS_ASSERT_MSG (m_trackInFlight, "Data packets in flight are not tracked");
+  int64_t oldest = (Simulator::Now () - maxPerHopDelay).GetTimeStep ();
+  for (std::unordered_map<uint64_t, int64_t>::iterator i = m_inFlight.begin (); i != m_inFlight.end (); )
+    {
+      if (i->second < oldest)
+        {
+          i = m_inFlight.erase (i);
+          m_dataLost++;
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  return m_inFlight.size ();
+}
+
+uint64_t
+TrafficCounters::GetDataLost (void) const
+{
+  return m_dataLost;
+}
+
+uint64_t
+TrafficCounters::GetTxPackets (Class c) const
+{
+  return m_txPackets[c];
+}
+
+uint64_t
+TrafficCounters::GetTxBytes (Class c) const
+{
+  return m_txBytes[c];
+}
+
+uint64_t
+TrafficCounters::GetRxPackets (Class c) const
+{
+  return m_rxPackets[c];
+}
+
+uint64_t
+TrafficCounters::GetRxBytes (Class c) const
+{
+  return m_rxBytes[c];
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_TRAFFIC_COUNTERS_H
+#define VANETRC_TRAFFIC_COUNTERS_H
+
+#include <unordered_map>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "flow-table.h"
+
+namespace ns3 {
+
+/**
+ * IP-level packet and byte counters of the data and the control traffic.
+ *
+ * A packet is data if it carries a FlowStampTag, i.e. an OnOff source of
+ * the flow table sent it; everything else (routing messages, ICMP) is
+ * control. Packets and bytes, IP header included, are counted when a node
+ * originates them (SendOutgoing) and when a node receives them for itself
+ * (LocalDeliver), so a broadcast counts once per receiver. A data packet
+ * only counts at its flow's source and sink: DSR hands data up to its own
+ * layer and sends it again at every relay, which IP sees as a delivery and
+ * a new packet per hop.
+ *
+ * When constructed with trackInFlight, data packets are also followed hop
+ * by hop until they are delivered or dropped by IP; one that makes no
+ * progress for the per-hop delay given to ExpireDataInFlight () is counted
+ * lost, the same rule FlowMonitor uses. Without it nothing is kept per
+ * packet, so a run that never expires packets does not accumulate the
+ * lost ones.
+ */
+class TrafficCounters : public SimpleRefCount<TrafficCounters>
+{
+public:
+  enum Class
+  {
+    DATA = 0,
+    CONTROL = 1
+  };
+
+  /// \param trackInFlight follow data packets for ExpireDataInFlight ()
+  explicit TrafficCounters (bool trackInFlight = false);
+
+  /// Count the IP traffic of nodes, which must have an internet stack
+  void Install (const NodeContainer &nodes);
+  /// Sources and sinks of the data flows, once they are known
+  void SetFlows (const FlowTable &flows);
+
+  uint64_t GetTxPackets (Class c) const;
+  uint64_t GetTxBytes (Class c) const;
+  uint64_t GetRxPackets (Class c) const;
+  uint64_t GetRxBytes (Class c) const;
+
+  /**
+   * Count as lost the data packets last seen more than maxPerHopDelay ago.
+   * Needs trackInFlight.
+   *
+   * \return the data packets still in flight
+   */
+  uint64_t ExpireDataInFlight (Time maxPerHopDelay);
+  /// Data packets dropped by IP or expired
+  uint64_t GetDataLost (void) const;
+
+private:
+  static void SendOutgoing (TrafficCounters *counters, uint32_t node, const Ipv4Header &header,
+                            Ptr<const Packet> packet, uint32_t interface);
+  static void LocalDeliver (TrafficCounters *counters, uint32_t node, const Ipv4Header &header,
+                            Ptr<const Packet> packet, uint32_t interface);
+  void UnicastForward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+  void Drop (const Ipv4Header &header, Ptr<const Packet> packet,
+             Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /// Flow of a data packet, or -1 for control
+  int64_t DataFlow (Ptr<const Packet> packet) const;
+  /// A data packet moved on, without leaving the network
+  void Progress (Ptr<const Packet> packet);
+
+  uint64_t m_txPackets[2];
+  uint64_t m_txBytes[2];
+  uint64_t m_rxPackets[2];
+  uint64_t m_rxBytes[2];
+  uint64_t m_dataLost;
+  bool m_trackInFlight;
+  std::vector<FlowSpec> m_flows;
+  /// Data packets in flight, by packet uid, and when they were last seen
+  std::unordered_map<uint64_t, int64_t> m_inFlight;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_TRAFFIC_COUNTERS_H */
@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "vehicle-state-table.h"
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("VehicleStateTable");
+
+VehicleStateTable::VehicleStateTable (uint32_t n, double cellSize)
+  : m_condition (n, 0),
+    m_role (n, RELAY),
+    m_flows (n, 0),
+    m_x (n, 0),
+    m_y (n, 0),
+    m_z (n, 0),
+    m_minCellSize (cellSize),
+    m_cellSize (cellSize),
+    m_minX (0),
+    m_minY (0),
+    m_nx (1),
+    m_ny (1)
+{
+  NS_ASSERT (cellSize > 0);
+  Rebin ();
+}
+
+uint32_t
+VehicleStateTable::GetN (void) const
+{
+  return m_condition.size ();
+}
+
+uint32_t
+VehicleStateTable::GetCondition (uint32_t id) const
+{
+  NS_ASSERT (id < m_condition.size ());
+  return m_condition[id];
+}
+
+void
+VehicleStateTable::SetCondition (uint32_t id, uint32_t condition)
+{
+  NS_ASSERT (id < m_condition.size ());
+  m_condition[id] = condition;
+}
+
+const uint32_t *
+VehicleStateTable::GetConditions (void) const
+{
+  return m_condition.data ();
+}
+
+uint8_t
+VehicleStateTable::GetRole (uint32_t id) const
+{
+  NS_ASSERT (id < m_role.size ());
+  return m_role[id];
+}
+
+uint32_t
+VehicleStateTable::GetFlowCount (uint32_t id) const
+{
+  NS_ASSERT (id < m_flows.size ());
+  return m_flows[id];
+}
+
+void
+VehicleStateTable::AddFlow (uint32_t source, uint32_t sink)
+{
+  NS_ASSERT (source < m_role.size () && sink < m_role.size ());
+  m_role[source] |= SOURCE;
+  m_role[sink] |= SINK;
+  m_flows[source]++;
+  m_flows[sink]++;
+}
+
+void
+VehicleStateTable::ClearFlows (void)
+{
+  std::fill (m_role.begin (), m_role.end (), uint8_t (RELAY));
+  std::fill (m_flows.begin (), m_flows.end (), 0);
+}
+
+void
+VehicleStateTable::Snapshot (const NodeContainer &nodes)
+{
+  NS_LOG_FUNCTION (this << nodes.GetN ());
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      uint32_t id = (*i)->GetId ();
+      NS_ASSERT_MSG (id < m_x.size (), "Node " << id << " is not in the table");
+      Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel> ();
+      if (mobility == 0)
+        {
+          continue;
+        }
+      Vector p = mobility->GetPosition ();
+      m_x[id] = p.x;
+      m_y[id] = p.y;
+      m_z[id] = p.z;
+    }
+  m_snapshotTime = Simulator::Now ();
+  Rebin ();
+}
+
+Time
+VehicleStateTable::GetSnapshotTime (void) const
+{
+  return m_snapshotTime;
+}
+
+Vector
+VehicleStateTable::GetPosition (uint32_t id) const
+{
+  NS_ASSERT (id < m_x.size ());
+  return Vector (m_x[id], m_y[id], m_z[id]);
+}
+
+void
+VehicleStateTable::Rebin (void)
+{
+  uint32_t n = m_x.size ();
+  double maxX = 0, maxY = 0;
+  m_minX = 0;
+  m_minY = 0;
+  if (n > 0)
+    {
+      m_minX = maxX = m_x[0];
+      m_minY = maxY = m_y[0];
+      for (uint32_t i = 1; i < n; i++)
+        {
+          m_minX = std::min (m_minX, m_x[i]);
+          maxX = std::max (maxX, m_x[i]);
+          m_minY = std::min (m_minY, m_y[i]);
+          maxY = std::max (maxY, m_y[i]);
+        }
+    }
+
+  m_cellSize = m_minCellSize;
+  while (true)
+    {
+      m_nx = uint32_t ((maxX - m_minX) / m_cellSize) + 1;
+      m_ny = uint32_t ((maxY - m_minY) / m_cellSize) + 1;
+      if (double (m_nx) * m_ny <= 4.0 * n + 4)
+        {
+          break;
+        }
+      m_cellSize *= 2;
+    }
+
+  // Counting sort of the ids by cell
+  std::vector<uint32_t> cell (n);
+  m_cellStart.assign (m_nx * m_ny + 1, 0);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      cell[i] = CellY (m_y[i]) * m_nx + CellX (m_x[i]);
+      m_cellStart[cell[i] + 1]++;
+    }
+  for (uint32_t c = 0; c < m_nx * m_ny; c++)
+    {
+      m_cellStart[c + 1] += m_cellStart[c];
+    }
+  m_cellIds.resize (n);
+  std::vector<uint32_t> next (m_cellStart.begin (), m_cellStart.end () - 1);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_cellIds[next[cell[i]]++] = i;
+    }
+}
+
+uint32_t
+VehicleStateTable::CellX (double x) const
+{
+  double c = std::floor ((x - m_minX) / m_cellSize);
+  return uint32_t (std::min (std::max (c, 0.0), double (m_nx - 1)));
+}
+
+uint32_t
+VehicleStateTable::CellY (double y) const
+{
+  double c = std::floor ((y - m_minY) / m_cellSize);
+  return uint32_t (std::min (std::max (c, 0.0), double (m_ny - 1)));
+}
+
+uint32_t
+VehicleStateTable::FindInRadius (const Vector &center, double radius, uint32_t minCondition,
+                                 std::vector<uint32_t> &out) const
+{
+  uint32_t found = 0;
+  double r2 = radius * radius;
+  uint32_t x0 = CellX (center.x - radius), x1 = CellX (center.x + radius);
+  uint32_t y0 = CellY (center.y - radius), y1 = CellY (center.y + radius);
+  for (uint32_t cy = y0; cy <= y1; cy++)
+    {
+      for (uint32_t c = cy * m_nx + x0; c <= cy * m_nx + x1; c++)
+        {
+          for (uint32_t k = m_cellStart[c]; k < m_cellStart[c + 1]; k++)
+            {
+              uint32_t id = m_cellIds[k];
+              if (m_condition[id] < minCondition)
+                {
+                  continue;
+                }
+              double dx = m_x[id] - center.x, dy = m_y[id] - center.y;
+              if (dx * dx + dy * dy <= r2)
+                {
+                  out.push_back (id);
+                  found++;
+                }
+            }
+        }
+    }
+  return found;
+}
+
+} // namespace ns3
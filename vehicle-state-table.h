@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_VEHICLE_STATE_TABLE_H
+#define VANETRC_VEHICLE_STATE_TABLE_H
+
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * Per-vehicle scenario state, one array per field, indexed by node id.
+ *
+ * The scenario sets condition, role and flow count; aodv-cond reads the
+ * conditions. Snapshot () copies the nodes' positions in for GetPosition ()
+ * and FindInRadius () and bins them into a uniform grid of at most about
+ * four cells per node, so that a radius query only looks at the cells the
+ * circle overlaps. Nothing in the scenario queries positions, so no
+ * snapshot is taken unless a caller asks for one.
+ */
+class VehicleStateTable : public SimpleRefCount<VehicleStateTable>
+{
+public:
+  /// Role flags; a node with neither is a relay
+  enum Role
+  {
+    RELAY = 0,
+    SOURCE = 1,
+    SINK = 2
+  };
+
+  /**
+   * \param n number of nodes, ids 0 to n - 1
+   * \param cellSize smallest grid cell edge, meters
+   */
+  VehicleStateTable (uint32_t n, double cellSize = 250);
+
+  uint32_t GetN (void) const;
+
+  uint32_t GetCondition (uint32_t id) const;
+  void SetCondition (uint32_t id, uint32_t condition);
+  /// All conditions, GetN () entries
+  const uint32_t *GetConditions (void) const;
+
+  /// Role flags of the node
+  uint8_t GetRole (uint32_t id) const;
+  /// Flows the node is an endpoint of
+  uint32_t GetFlowCount (uint32_t id) const;
+  /// Make source and sink endpoints of one more flow
+  void AddFlow (uint32_t source, uint32_t sink);
+  void ClearFlows (void);
+
+  /// Copy the nodes' positions and rebuild the grid
+  void Snapshot (const NodeContainer &nodes);
+  Time GetSnapshotTime (void) const;
+  /// Position of the node at the last snapshot
+  Vector GetPosition (uint32_t id) const;
+
+  /**
+   * Append to out the nodes with at least minCondition that were within
+   * radius of center (in the x-y plane) at the last snapshot.
+   *
+   * \return the number of nodes appended
+   */
+  uint32_t FindInRadius (const Vector &center, double radius, uint32_t minCondition,
+                         std::vector<uint32_t> &out) const;
+
+private:
+  void Rebin (void);
+  /// Grid cell of a coordinate, clamped to the grid
+  uint32_t CellX (double x) const;
+  uint32_t CellY (double y) const;
+
+  std::vector<uint32_t> m_condition;
+  std::vector<uint8_t> m_role;
+  std::vector<uint32_t> m_flows;
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<double> m_z;
+  Time m_snapshotTime;
+
+  double m_minCellSize;
+  double m_cellSize;
+  double m_minX;
+  double m_minY;
+  uint32_t m_nx;
+  uint32_t m_ny;
+  /// Node ids grouped by cell; cell c holds m_cellIds[m_cellStart[c] .. m_cellStart[c + 1])
+  std::vector<uint32_t> m_cellStart;
+  std::vector<uint32_t> m_cellIds;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_VEHICLE_STATE_TABLE_H */
@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_VEHICLE_TRACE_FORMAT_H
+#define VANETRC_VEHICLE_TRACE_FORMAT_H
+
+#include <stdint.h>
+
+/*
+ * Binary vehicle trace, written by tools/vanetrc-trace-convert and replayed
+ * by TraceMobilityModel. Host byte order.
+ *
+ *   VehicleTraceHeader
+ *   VehicleTraceRecord records[header.records]       sorted by time
+ *   uint64_t windowIndex[header.windows + 1]          first record of each window
+ *   uint64_t firstRecord[header.vehicles]             VEHICLE_TRACE_NONE if absent
+ *
+ * Window w covers [startTime + w * windowSeconds, startTime + (w + 1) * windowSeconds).
+ * Each record links to the same vehicle's next record, so a position is
+ * interpolated without searching the trace.
+ */
+
+#define VEHICLE_TRACE_MAGIC "VRCTRC1"
+#define VEHICLE_TRACE_VERSION 1
+#define VEHICLE_TRACE_NONE UINT64_MAX
+
+struct VehicleTraceHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t vehicles;       //!< largest vehicle id + 1
+  uint64_t records;
+  uint64_t windows;
+  double windowSeconds;
+  double startTime;
+  double maxSpeed;         //!< fastest speed in the trace, m/s
+  uint64_t reserved;
+};
+
+struct VehicleTraceRecord
+{
+  double time;             //!< s
+  uint32_t id;
+  uint32_t next;           //!< records to this vehicle's next one, 0 if none
+  float x;                 //!< m
+  float y;                 //!< m
+  float speed;             //!< m/s
+  uint32_t reserved;
+};
+
+static_assert (sizeof (VehicleTraceHeader) == 64, "VehicleTraceHeader layout");
+static_assert (sizeof (VehicleTraceRecord) == 32, "VehicleTraceRecord layout");
+
+#endif /* VANETRC_VEHICLE_TRACE_FORMAT_H */
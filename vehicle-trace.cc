@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "vehicle-trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("VehicleTrace");
+
+VehicleTrace::VehicleTrace ()
+  : m_fd (-1),
+    m_base (0),
+    m_length (0),
+    m_header (0),
+    m_records (0),
+    m_windowIndex (0),
+    m_firstRecord (0),
+    m_cursor (0),
+    m_window (0)
+{
+}
+
+VehicleTrace::~VehicleTrace ()
+{
+  if (m_base)
+    {
+      munmap (m_base, m_length);
+    }
+  if (m_fd >= 0)
+    {
+      close (m_fd);
+    }
+}
+
+bool
+VehicleTrace::Open (const std::string &path)
+{
+  NS_LOG_FUNCTION (this << path);
+  m_fd = open (path.c_str (), O_RDONLY);
+  struct stat st;
+  if (m_fd < 0 || fstat (m_fd, &st) != 0 || st.st_size < (off_t) sizeof (VehicleTraceHeader))
+    {
+      NS_LOG_ERROR ("Cannot open vehicle trace " << path);
+      return false;
+    }
+  m_length = st.st_size;
+  void *base = mmap (0, m_length, PROT_READ, MAP_SHARED, m_fd, 0);
+  if (base == MAP_FAILED)
+    {
+      NS_LOG_ERROR ("Cannot map vehicle trace " << path);
+      return false;
+    }
+  m_base = static_cast<uint8_t *> (base);
+  m_header = reinterpret_cast<const VehicleTraceHeader *> (m_base);
+  // Bounded first, so that the expected length cannot wrap around
+  if (m_header->records > m_length / sizeof (VehicleTraceRecord)
+      || m_header->windows >= m_length / sizeof (uint64_t))
+    {
+      NS_LOG_ERROR (path << " is not a version " << VEHICLE_TRACE_VERSION << " vehicle trace");
+      return false;
+    }
+  uint64_t expected = sizeof (VehicleTraceHeader)
+    + m_header->records * sizeof (VehicleTraceRecord)
+    + (m_header->windows + 1) * sizeof (uint64_t)
+    + uint64_t (m_header->vehicles) * sizeof (uint64_t);
+  if (std::memcmp (m_header->magic, VEHICLE_TRACE_MAGIC, 8) != 0
+      || m_header->version != VEHICLE_TRACE_VERSION
+      || expected != m_length)
+    {
+      NS_LOG_ERROR (path << " is not a version " << VEHICLE_TRACE_VERSION << " vehicle trace");
+      return false;
+    }
+  m_records = reinterpret_cast<const VehicleTraceRecord *> (m_base + sizeof (VehicleTraceHeader));
+  m_windowIndex = reinterpret_cast<const uint64_t *> (m_records + m_header->records);
+  m_firstRecord = m_windowIndex + m_header->windows + 1;
+  // The indexes are small next to the records; Advance () checks those
+  // as it reaches them, so that the file is still read front to back once
+  for (uint64_t w = 0; w <= m_header->windows; w++)
+    {
+      if (m_windowIndex[w] > m_header->records || (w > 0 && m_windowIndex[w] < m_windowIndex[w - 1]))
+        {
+          NS_LOG_ERROR (path << ": window " << w << " starts at record " << m_windowIndex[w]
+                             << " of " << m_header->records);
+          return false;
+        }
+    }
+  for (uint32_t v = 0; v < m_header->vehicles; v++)
+    {
+      if (m_firstRecord[v] != VEHICLE_TRACE_NONE && m_firstRecord[v] >= m_header->records)
+        {
+          NS_LOG_ERROR (path << ": vehicle " << v << " starts at record " << m_firstRecord[v]
+                             << " of " << m_header->records);
+          return false;
+        }
+    }
+  m_current.assign (m_header->vehicles, VEHICLE_TRACE_NONE);
+  m_cursor = 0;
+  m_window = 0;
+
+  // The cursor walks the records front to back
+  madvise (m_base, m_length, MADV_SEQUENTIAL);
+  Prefetch (0, m_windowIndex[std::min<uint64_t> (1, m_header->windows)]);
+  return true;
+}
+
+uint32_t
+VehicleTrace::GetVehicles (void) const
+{
+  return m_header ? m_header->vehicles : 0;
+}
+
+double
+VehicleTrace::GetMaxSpeed (void) const
+{
+  return m_header ? m_header->maxSpeed : 0;
+}
+
+void
+VehicleTrace::Release (uint64_t first, uint64_t last)
+{
+  long page = sysconf (_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t> (m_records + first);
+  uintptr_t end = reinterpret_cast<uintptr_t> (m_records + last);
+  // Only whole pages, the edges may hold records that are still needed
+  begin = (begin + page - 1) / page * page;
+  end = end / page * page;
+  if (end > begin)
+    {
+      madvise (reinterpret_cast<void *> (begin), end - begin, MADV_DONTNEED);
+    }
+}
+
+void
+VehicleTrace::Prefetch (uint64_t first, uint64_t last)
+{
+  long page = sysconf (_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t> (m_records + first) / page * page;
+  uintptr_t end = reinterpret_cast<uintptr_t> (m_records + last);
+  if (end > begin)
+    {
+      madvise (reinterpret_cast<void *> (begin), end - begin, MADV_WILLNEED);
+    }
+}
+
+void
+VehicleTrace::Advance (double t)
+{
+  while (m_cursor < m_header->records && m_records[m_cursor].time <= t)
+    {
+      const VehicleTraceRecord &r = m_records[m_cursor];
+      NS_ABORT_MSG_IF (r.id >= m_header->vehicles || r.next >= m_header->records - m_cursor,
+                       "Vehicle trace record " << m_cursor << " is corrupt (vehicle " << r.id
+                       << ", next " << r.next << ")");
+      m_current[r.id] = m_cursor;
+      m_cursor++;
+    }
+  // Windows are only crossed forward; records that vehicles still point
+  // into are simply paged back in from the page cache if they are read
+  while (m_window + 1 < m_header->windows && m_windowIndex[m_window + 1] <= m_cursor)
+    {
+      m_window++;
+      if (m_window >= 2)
+        {
+          Release (m_windowIndex[m_window - 2], m_windowIndex[m_window - 1]);
+        }
+      Prefetch (m_windowIndex[m_window + 1], m_windowIndex[std::min (m_window + 2, m_header->windows)]);
+    }
+}
+
+void
+VehicleTrace::Locate (uint32_t id, double t, Vector &position, Vector &velocity)
+{
+  NS_ABORT_MSG_IF (id >= m_header->vehicles, "Vehicle " << id << " is not in the trace");
+  // Record times are trace times; simulation time 0 is the first sample's
+  t += m_header->startTime;
+  Advance (t);
+  velocity = Vector (0, 0, 0);
+  uint64_t r = m_current[id];
+  if (r == VEHICLE_TRACE_NONE)
+    {
+      r = m_firstRecord[id];
+      if (r == VEHICLE_TRACE_NONE)
+        {
+          position = Vector (0, 0, 0);
+          return;
+        }
+      position = Vector (m_records[r].x, m_records[r].y, 0);
+      return;
+    }
+  const VehicleTraceRecord &from = m_records[r];
+  if (from.next == 0)
+    {
+      position = Vector (from.x, from.y, 0);
+      return;
+    }
+  const VehicleTraceRecord &to = m_records[r + from.next];
+  double dt = to.time - from.time;
+  double alpha = dt > 0 ? (t - from.time) / dt : 0;
+  position = Vector (from.x + alpha * (to.x - from.x), from.y + alpha * (to.y - from.y), 0);
+  if (dt > 0)
+    {
+      velocity = Vector ((to.x - from.x) / dt, (to.y - from.y) / dt, 0);
+    }
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (TraceMobilityModel);
+
+TypeId
+TraceMobilityModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceMobilityModel")
+    .SetParent<MobilityModel> ()
+    .AddConstructor<TraceMobilityModel> ()
+  ;
+  return tid;
+}
+
+TraceMobilityModel::TraceMobilityModel ()
+  : m_vehicle (0)
+{
+}
+
+void
+TraceMobilityModel::SetTrace (Ptr<VehicleTrace> trace, uint32_t vehicle)
+{
+  m_trace = trace;
+  m_vehicle = vehicle;
+}
+
+Vector
+TraceMobilityModel::DoGetPosition (void) const
+{
+  Vector position, velocity;
+  m_trace->Locate (m_vehicle, Simulator::Now ().GetSeconds (), position, velocity);
+  return position;
+}
+
+void
+TraceMobilityModel::DoSetPosition (const Vector &position)
+{
+  NS_LOG_WARN ("Ignoring SetPosition on a trace-driven node");
+}
+
+Vector
+TraceMobilityModel::DoGetVelocity (void) const
+{
+  Vector position, velocity;
+  m_trace->Locate (m_vehicle, Simulator::Now ().GetSeconds (), position, velocity);
+  return velocity;
+}
+
+} // namespace ns3
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef VANETRC_VEHICLE_TRACE_H
+#define VANETRC_VEHICLE_TRACE_H
+
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+#include "ns3/mobility-model.h"
+#include "ns3/vector.h"
+#include "vehicle-trace-format.h"
+
+namespace ns3 {
+
+/**
+ * A memory-mapped binary vehicle trace (see vehicle-trace-format.h).
+ *
+ * Nothing is parsed up front. A cursor follows simulation time and, for
+ * each vehicle, remembers its latest record; a position is interpolated
+ * between that record and the vehicle's next one. When the cursor enters a
+ * new time window the pages of the windows before the previous one are
+ * released and the next window is prefetched, so only about three windows
+ * of a multi-GB trace are resident at any time.
+ */
+class VehicleTrace : public SimpleRefCount<VehicleTrace>
+{
+public:
+  VehicleTrace ();
+  ~VehicleTrace ();
+
+  /**
+   * A record whose vehicle id or link points outside the trace aborts the
+   * run when the replay reaches it.
+   *
+   * \return false if the file cannot be mapped, is not a vehicle trace or
+   *         its window or vehicle index points past the records
+   */
+  bool Open (const std::string &path);
+
+  uint32_t GetVehicles (void) const;
+  double GetMaxSpeed (void) const;
+
+  /**
+   * Position and velocity of vehicle id at simulation time t, which
+   * replays the trace from its first sample on. Before its first record
+   * a vehicle waits at its first position, after its last one at its last
+   * position. Times must not decrease between calls.
+   */
+  void Locate (uint32_t id, double t, Vector &position, Vector &velocity);
+
+private:
+  void Advance (double t);
+  /// Drop the pages of the records in [first, last)
+  void Release (uint64_t first, uint64_t last);
+  /// Prefetch the pages of the records in [first, last)
+  void Prefetch (uint64_t first, uint64_t last);
+
+  int m_fd;
+  uint8_t *m_base;
+  size_t m_length;
+  const VehicleTraceHeader *m_header;
+  const VehicleTraceRecord *m_records;
+  const uint64_t *m_windowIndex;
+  const uint64_t *m_firstRecord;
+
+  uint64_t m_cursor;                  //!< first record not yet applied
+  uint64_t m_window;                  //!< window of the cursor
+  std::vector<uint64_t> m_current;    //!< per vehicle, latest applied record
+};
+
+/**
+ * Mobility model replaying one vehicle of a VehicleTrace. The position is
+ * only computed when somebody asks for it.
+ */
+class TraceMobilityModel : public MobilityModel
+{
+public:
+  static TypeId GetTypeId (void);
+  TraceMobilityModel ();
+
+  void SetTrace (Ptr<VehicleTrace> trace, uint32_t vehicle);
+
+private:
+  virtual Vector DoGetPosition (void) const;
+  virtual void DoSetPosition (const Vector &position);
+  virtual Vector DoGetVelocity (void) const;
+
+  Ptr<VehicleTrace> m_trace;
+  uint32_t m_vehicle;
+};
+
+} // namespace ns3
+
+#endif /* VANETRC_VEHICLE_TRACE_H */